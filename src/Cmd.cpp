@@ -1,5 +1,7 @@
 #include "Cmd.hpp"
 
+#include <map>
+
 #ifdef _OPENMP
 #define OMP_P 1
 #else
@@ -107,7 +109,7 @@ Cmd::Cmd(int argc, const char** argv)
                                                   "\tresetting BM with shift   : 18",
                                      false, type, &allowedWT);
 
-        std::vector<int> ch({0, 1, 2, 3, 4, 5});
+        std::vector<int> ch({0, 1, 2, 3, 4, 5, 6, 7, 8});
         TCLAP::ValuesConstraint<int> allowedCH(ch);
         TCLAP::ValueArg<int> chAlgArg("c", "convexHullAlgo", "convex hull algorithm:\n"
                                                              "\tNOP (do nothing)      : 0\n"
@@ -115,7 +117,10 @@ Cmd::Cmd(int argc, const char** argv)
                                                              "\tAndrews Monotone Chain: 2\n"
                                                              "\tGraham Scan           : 3\n"
                                                              "\tJarvis March          : 4\n"
-                                                             "\tChans                 : 5",
+                                                             "\tChans                 : 5\n"
+                                                             "\tSegment Tree          : 6\n"
+                                                             "\tnative Quickhull (3D) : 7\n"
+                                                             "\tColumn Extrema        : 8",
                                       false, chAlg, &allowedCH);
         std::vector<int> wo({1, 2, 3});
         TCLAP::ValuesConstraint<int> allowedWO(wo);
@@ -151,6 +156,9 @@ Cmd::Cmd(int argc, const char** argv)
         // -short, --long, description, default
         TCLAP::SwitchArg aklHeuristicSwitch("a", "aklHeuristic", "enables the Akl Toussaint heuristic", false);
         TCLAP::SwitchArg simpleSamplingSwitch("", "simplesampling", "use simple sampling instead of the large deviation scheme", false);
+        TCLAP::SwitchArg permSwitch("", "perm", "generate self-avoiding walks with PERM, one tour per iteration, the log of the weight of every walk is the last column (only simple sampling of self-avoiding walks)", false);
+        TCLAP::SwitchArg philoxRNSwitch("", "philoxRN", "draw the realization from the counter based Philox stream instead of the Mersenne Twister, which generates gaussian random numbers in blocks (results differ from runs without this switch)", false);
+        TCLAP::SwitchArg onDemandRNSwitch("", "onDemandRN", "calculate the random numbers of the walk when needed instead of storing them (only lattice and gaussian random walks)", false);
         TCLAP::SwitchArg onlyBoundsSwitch("", "onlyBounds", "just output minimum and maximum of the wanted observable and exit", false);
         TCLAP::SwitchArg onlyCentersSwitch("", "onlyCenters", "just output the centers of the WL bins and exit", false);
         TCLAP::SwitchArg onlyLERWExampleSwitch("", "onlyLERWExample", "just output a picture of erased loops", false);
@@ -202,6 +210,9 @@ Cmd::Cmd(int argc, const char** argv)
 
         cmd.add(aklHeuristicSwitch);
         cmd.add(simpleSamplingSwitch);
+        cmd.add(onDemandRNSwitch);
+        cmd.add(philoxRNSwitch);
+        cmd.add(permSwitch);
 
         cmd.add(onlyBoundsSwitch);
         cmd.add(onlyCentersSwitch);
@@ -387,12 +398,31 @@ Cmd::Cmd(int argc, const char** argv)
             exit(1);
         }
 
+        // the segment tree needs all points, the native quickhull and
+        // the column extrema select their candidates themselves
+        const std::map<int, hull_algorithm_t> withoutAkl = {
+            {6, CH_SEGMENT_TREE},
+            {7, CH_QUICKHULL_3D},
+            {8, CH_COLUMN_EXTREMA}
+        };
         bool aklHeuristic = aklHeuristicSwitch.getValue();
         int tmp = chAlgArg.getValue();
-        if(tmp > 0)
-            tmp = (tmp-1)*2 + 1;
-        if(aklHeuristic && tmp > 0)
-            tmp++;
+        const auto noAkl = withoutAkl.find(tmp);
+        if(noAkl != withoutAkl.end())
+        {
+            if(aklHeuristic)
+            {
+                LOG(LOG_WARNING) << "Akl Toussaint heuristic is not used with " << CH_LABEL[noAkl->second];
+            }
+            tmp = noAkl->second;
+        }
+        else
+        {
+            if(tmp > 0)
+                tmp = (tmp-1)*2 + 1;
+            if(aklHeuristic && tmp > 0)
+                tmp++;
+        }
         chAlg = (hull_algorithm_t) tmp;
         if(d==1)
             chAlg = CH_1D;
@@ -463,6 +493,34 @@ Cmd::Cmd(int argc, const char** argv)
             LOG(LOG_WARNING) << "The --simplesampling switch is a badly named. It just ensures that Metropolis is simulated at infinite temperature. It is useless for every other sampling method";
         }
 
+        perm = permSwitch.getValue();
+        if(perm && (type != WT_SELF_AVOIDING_RANDOM_WALK || sampling_method != SM_SIMPLESAMPLING || numWalker != 1))
+        {
+            LOG(LOG_ERROR) << "--perm is only available for simple sampling of a single self-avoiding walk";
+            exit(1);
+        }
+        else if(perm)
+        {
+            LOG(LOG_INFO) << "PERM tours                 ";
+        }
+
+        onDemandRN = onDemandRNSwitch.getValue();
+        if(onDemandRN && perm)
+        {
+            LOG(LOG_WARNING) << "PERM sets the steps directly, --onDemandRN is ignored";
+            onDemandRN = false;
+        }
+        else if(onDemandRN)
+        {
+            LOG(LOG_INFO) << "random numbers on demand   ";
+        }
+
+        philoxRN = philoxRNSwitch.getValue();
+        if(philoxRN)
+        {
+            LOG(LOG_INFO) << "Philox realizations        ";
+        }
+
         t_eq = t_eqArg.getValue();
         if(sampling_method == SM_METROPOLIS || sampling_method == SM_METROPOLIS_PARALLEL_TEMPERING || sampling_method == SM_METROPOLIS_PARALLEL_TEMPERING_MPI)
             if(t_eq >= 0)
@@ -22,13 +22,16 @@ enum hull_algorithm_t {
     CH_QHULL_AKL,   ///< use the quick hull implementation Qhull with Akl's heuristic
     CH_ANDREWS,     ///< use Andrews monotone chain algorithm
     CH_ANDREWS_AKL, ///< use Andrews monotone chain algorithm with Akl's heuristic
-    CH_GRAHAM,      ///< [not implemented]
-    CH_GRAHAM_AKL,  ///< [not implemented]
+    CH_GRAHAM,      ///< use Graham's scan
+    CH_GRAHAM_AKL,  ///< use Graham's scan with Akl's heuristic
     CH_JARVIS,      ///< use Jarvis' march (gift wrapping)
     CH_JARVIS_AKL,  ///< use Jarvis' march (gift wrapping) with Akl's heuristic
-    CH_CHAN,        ///< [not implemented]
-    CH_CHAN_AKL,    ///< [not implemented]
-    CH_1D           ///< boring case of 1 dimensional hull
+    CH_CHAN,        ///< use Chan's algorithm, output sensitive O(n log h)
+    CH_CHAN_AKL,    ///< use Chan's algorithm with Akl's heuristic
+    CH_1D,          ///< boring case of 1 dimensional hull
+    CH_SEGMENT_TREE,///< segment tree of partial hulls, for fast updates after local changes
+    CH_QUICKHULL_3D,///< native quickhull for d=3 with exact predicates for lattice walks
+    CH_COLUMN_EXTREMA ///< monotone chain over the extremal points of every column, lattice walks in d=2
 };
 
 const std::vector<std::string> CH_LABEL = {
@@ -43,7 +46,10 @@ const std::vector<std::string> CH_LABEL = {
     "Jarvis + Akl",
     "Chan",
     "Chan + Akl",
-    "one dimensional"
+    "one dimensional",
+    "Segment Tree",
+    "Quickhull 3D",
+    "Column Extrema"
 };
 
 enum walk_type_t {
@@ -166,6 +172,9 @@ class Cmd
               theta(1e4),
               parallelTemperatures(),
               simpleSampling(false),
+              onDemandRN(false),
+              philoxRN(false),
+              perm(false),
               wangLandauBorders(),
               wangLandauBins(100),
               wangLandauOverlap(10),
@@ -218,6 +227,9 @@ class Cmd
         double theta;                               ///< temperature \f$\Theta\f$ to simulate at (only Metropolis type simulations)
         std::vector<double> parallelTemperatures;   ///< temperatures \f$\Theta\f$ to simulate at (only parallel tempering type simulations)
         bool simpleSampling;                        ///< use naive simple sampling
+        bool onDemandRN;                            ///< calculate the random numbers of the walk when needed instead of storing them
+        bool philoxRN;                              ///< draw the realization from a counter based Philox stream instead of the Mersenne Twister
+        bool perm;                                  ///< simple sampling of self-avoiding walks with PERM, one tour per iteration
         std::vector<double> wangLandauBorders;      ///< borders of the Wang Landau bins (only Wang Landau type simulations)
         int wangLandauBins;                         ///< number of Wang Landau bins
         int wangLandauOverlap;                      ///< overlap between Wang Landau ranges in bins
@@ -2,9 +2,12 @@
 #define CONVEXHULL_H
 
 #include <set>
+#include <array>
 #include <memory>
 #include <vector>
+#include <limits>
 #include <algorithm>
+#include <type_traits>
 #include <unordered_set>
 
 #include <Qhull.h>
@@ -41,11 +44,22 @@ class ConvexHull
         std::vector<Step<T>> *interiorPoints;
         mutable std::vector<Step<T>> hullPoints_;
 
+        int numRuns;
+
     public:
         ConvexHull(hull_algorithm_t algorithm=CH_QHULL)
             : n(0),
               d(0),
-              algorithm(algorithm)
+              algorithm(algorithm),
+              interiorPoints(nullptr),
+              numRuns(0),
+              pointOffsets(nullptr),
+              unionParts(-1),
+              numFaces3d(0),
+              visitMark3d(0),
+              trialActive(false),
+              trialSaved(false),
+              trialJournalSize(-1)
         {
         }
 
@@ -53,19 +67,38 @@ class ConvexHull
         ConvexHull(std::vector<Step<T>> *interiorPoints, hull_algorithm_t algorithm)
             : n(0),
               d(0),
-              algorithm(algorithm)
+              algorithm(algorithm),
+              interiorPoints(nullptr),
+              numRuns(0),
+              pointOffsets(nullptr),
+              unionParts(-1),
+              numFaces3d(0),
+              visitMark3d(0),
+              trialActive(false),
+              trialSaved(false),
+              trialJournalSize(-1)
         {
             run(interiorPoints);
         }
 
         void run(std::vector<Step<T>> *interiorPoints);
+        void update(std::vector<Step<T>> *interiorPoints, int firstStep, int lastStep,
+                    const std::vector<Step<T>> *offsets=nullptr, int offsetBlockSize=1);
+        void runUnion(const std::vector<const std::vector<Step<T>>*> &parts, int changed=-1);
         void setPoints(std::vector<Step<T>> *interiorPoints);
         void setHullAlgo(hull_algorithm_t alg);
 
+        // trial moves
+        void beginTrial();
+        void commit();
+        void rollback();
+
         // observables
         double A() const;
         double L() const;
         int num_vertices() const;
+        /// number of hull calculations by run() and update()
+        int num_runs() const { return numRuns; }
 
         // hull
         const std::vector<Step<T>>& hullPoints() const;
@@ -81,20 +114,128 @@ class ConvexHull
         void updateHullPoints() const;
         int countZerosAndUpdateCmd(std::string &cmd);
 
-        // for Andrews, and Jarvis
+        // for Andrews, Graham, Jarvis and Chan
         void runAndrews();
+        void runGraham();
         void runJarvis();
         void runChan();
         void preprocessAklToussaint();
+        void selectAllPoints();
+        void chanSubHulls(int m);
+        static bool wrapsFurther(const Step<T> &p, const Step<T> &a, const Step<T> &b);
 
         std::vector<Step<T>*> pointSelection;
+        std::vector<Step<T>*> hullPointStack;
         int zero_axis;
+
+        // for Chan, sub hull g is chanHulls[chanHullStart[g]:chanHullStart[g+1]]
+        std::vector<Step<T>*> chanHulls;
+        std::vector<int> chanHullStart;
+        std::vector<int> chanTangent;
+
+        // for the column extrema of lattice walks
+        void runColumnExtrema();
+
+        std::vector<T> columnMin;
+        std::vector<T> columnMax;
+        std::vector<Step<T>> columnCandidates;
+
+        // for the segment tree
+        void runSegmentTree();
+        void updateSegmentTree(int firstStep, int lastStep);
+        void buildSegmentTreeLeaf(int k);
+        void buildSegmentTreeNode(int k);
+        void sortedHullVertices(std::vector<Step<T>> &sorted);
+        static int monotoneChain(const std::vector<Step<T>> &sorted, std::vector<Step<T>> &hull);
+
+        Step<T> segmentTreePoint(int i) const;
+
+        static const int segmentTreeLeafSize = 32;
+        int segmentTreeLeaves;
+        std::vector<int> segmentTreeLo;
+        std::vector<std::vector<Step<T>>> segmentTree;
+        std::vector<Step<T>> segmentTreeBuffer;
+        std::vector<Step<T>> segmentTreeChain;
+        const std::vector<Step<T>> *pointOffsets;
+        int pointOffsetBlockSize;
+
+        // for the union of several point sets, whose hulls are the
+        // leaves of a tree like the segment tree
+        void buildUnionLeaf(int k, const std::vector<Step<T>> *part);
+        void buildUnionNode(int k);
+
+        int unionParts; ///< number of parts of the union tree, -1 if there is none
+        std::vector<Step<T>> unionPoints;
+
+        // for the native 3D quickhull
+        void runQuickhull3D();
+        void planarHull3D(int i0, int i1, int i2);
+        void extremeVertices3D();
+        int addFace3D(int a, int b, int c);
+        typename exact_t<T>::type faceOrientation3D(int f, int i) const;
+
+        struct Face3D
+        {
+            int v[3];                ///< vertices, counterclockwise seen from outside
+            int neighbor[3];         ///< face across the edge v[k] -> v[k+1]
+            int visited;
+            bool visible;
+            bool alive;
+            std::vector<int> outside; ///< indices of the points above this face
+        };
+        std::vector<Face3D> faces3d;
+        int numFaces3d;
+        int visitMark3d;
+        std::vector<int> faceStack3d;
+        std::vector<int> visibleFaces3d;
+        std::vector<std::pair<int, int>> horizon3d;
+        std::vector<int> newFaces3d;
+        std::vector<int> faceStartingAt3d;
+        std::vector<int> pointOrder3d;
+        std::vector<std::pair<int, int>> incidence3d;
+        std::vector<std::array<int, 3>> hullTriangles;
+
+        // for trial moves
+        void saveTrialState();
+        void swapTrialState();
+        void journalSegmentTreeNode(int k);
+        void rollbackSegmentTreeJournal();
+
+        bool trialActive;
+        bool trialSaved;
+        int trialJournalSize; ///< number of journaled nodes, -1 if the whole state is saved
+
+        /// everything run() writes, swapped in and out by trial moves
+        struct SavedState
+        {
+            int n = 0;
+            int d = 0;
+            double A = -1.;
+            double L = -1.;
+            std::vector<Step<T>> *interiorPoints = nullptr;
+            std::vector<Step<T>> hullPoints;
+            std::shared_ptr<orgQhull::Qhull> qhull;
+            std::vector<double> coords;
+            int zero_axis = -1;
+            int segmentTreeLeaves = 0;
+            int unionParts = -1;
+            std::vector<int> segmentTreeLo;
+            std::vector<std::vector<Step<T>>> segmentTree;
+            const std::vector<Step<T>> *pointOffsets = nullptr;
+            int pointOffsetBlockSize = 1;
+            std::vector<std::array<int, 3>> hullTriangles;
+        } saved;
+        std::vector<std::pair<int, std::vector<Step<T>>>> trialJournal;
 };
 
 /// Calculates the convex hull of the given points.
 template <class T>
 void ConvexHull<T>::run(std::vector<Step<T>> *points)
 {
+    ++numRuns;
+    if(trialActive)
+        saveTrialState();
+
     setPoints(points);
 
     switch(algorithm)
@@ -115,6 +256,12 @@ void ConvexHull<T>::run(std::vector<Step<T>> *points)
         case CH_ANDREWS:
             runAndrews();
             break;
+        case CH_GRAHAM_AKL:
+            preprocessAklToussaint();
+            // fall through
+        case CH_GRAHAM:
+            runGraham();
+            break;
         case CH_JARVIS_AKL:
             preprocessAklToussaint();
             // fall through
@@ -127,6 +274,15 @@ void ConvexHull<T>::run(std::vector<Step<T>> *points)
         case CH_CHAN:
             runChan();
             break;
+        case CH_SEGMENT_TREE:
+            runSegmentTree();
+            break;
+        case CH_QUICKHULL_3D:
+            runQuickhull3D();
+            break;
+        case CH_COLUMN_EXTREMA:
+            runColumnExtrema();
+            break;
         default:
             LOG(LOG_ERROR) << "Algorithm not implemented, yet: "
                            << CH_LABEL[algorithm];
@@ -134,6 +290,282 @@ void ConvexHull<T>::run(std::vector<Step<T>> *points)
     }
 }
 
+/** Updates the hull after the steps in [firstStep, lastStep] changed.
+ *
+ * The points are expected to be the same as in the last call of run()
+ * or update(), except that the steps firstStep to lastStep (i.e. the
+ * differences between point i and i+1) were changed and all following
+ * points were translated accordingly.
+ *
+ * Only CH_SEGMENT_TREE can take advantage of this, all other
+ * algorithms fall back to run().
+ *
+ * The segment tree does also accept points which are not yet
+ * translated, i.e., point i is at points[i] + offsets[i / offsetBlockSize].
+ */
+template <class T>
+void ConvexHull<T>::update(std::vector<Step<T>> *points, int firstStep, int lastStep,
+                           const std::vector<Step<T>> *offsets, int offsetBlockSize)
+{
+    if(algorithm != CH_SEGMENT_TREE)
+    {
+        run(points);
+        return;
+    }
+
+    const bool rebuild = points != interiorPoints
+                         || (int) points->size() != n
+                         || segmentTree.empty();
+
+    if(rebuild)
+    {
+        run(points);
+        return;
+    }
+    ++numRuns;
+
+    if(trialActive && !trialSaved)
+    {
+        // only the touched nodes need to be saved
+        std::swap(m_A, saved.A);
+        std::swap(m_L, saved.L);
+        hullPoints_.swap(saved.hullPoints);
+        saved.pointOffsets = pointOffsets;
+        saved.pointOffsetBlockSize = pointOffsetBlockSize;
+        trialJournalSize = 0;
+        trialSaved = true;
+    }
+
+    setPoints(points);
+    pointOffsets = offsets;
+    pointOffsetBlockSize = offsetBlockSize;
+
+    updateSegmentTree(firstStep, lastStep);
+}
+
+/** Constructs the hull of the union of all parts.
+ *
+ * In d=2 the hull of every part is a leaf of a tree, whose inner nodes
+ * are the merged hulls of their children, like the segment tree. If
+ * only the part changed differs from the last call, only its leaf and
+ * the ancestors are rebuilt, i.e., O(h log k) for k parts with hulls
+ * of about h vertices. The parts should therefore be the hull vertices
+ * of the point sets, the result does not depend on the algorithm.
+ *
+ * In other dimensions the parts are concatenated and passed to run().
+ *
+ * \param changed index of the only part, which changed since the last
+ *                call, or -1 to build from scratch
+ */
+template <class T>
+void ConvexHull<T>::runUnion(const std::vector<const std::vector<Step<T>>*> &parts, int changed)
+{
+    const int dim = parts[0]->empty() ? 2 : (*parts[0])[0].d();
+    if(dim != 2 || algorithm == CH_NOP || algorithm == CH_1D)
+    {
+        unionPoints.clear();
+        for(const auto p : parts)
+            unionPoints.insert(unionPoints.end(), p->begin(), p->end());
+        run(&unionPoints);
+        return;
+    }
+
+    const int k = parts.size();
+    if(changed < 0 || unionParts != k)
+    {
+        if(trialActive)
+            saveTrialState();
+
+        n = k;
+        d = dim;
+        interiorPoints = nullptr;
+        pointOffsets = nullptr;
+        unionParts = k;
+
+        segmentTreeLeaves = 1;
+        while(segmentTreeLeaves < k)
+            segmentTreeLeaves *= 2;
+        segmentTree.resize(2*segmentTreeLeaves);
+
+        for(int j=0; j<segmentTreeLeaves; ++j)
+            buildUnionLeaf(segmentTreeLeaves + j, j < k ? parts[j] : nullptr);
+        for(int j=segmentTreeLeaves-1; j>=1; --j)
+            buildUnionNode(j);
+    }
+    else
+    {
+        if(trialActive && !trialSaved)
+        {
+            // only the touched nodes need to be saved
+            std::swap(m_A, saved.A);
+            std::swap(m_L, saved.L);
+            hullPoints_.swap(saved.hullPoints);
+            saved.pointOffsets = pointOffsets;
+            saved.pointOffsetBlockSize = pointOffsetBlockSize;
+            trialJournalSize = 0;
+            trialSaved = true;
+        }
+
+        int j = segmentTreeLeaves + changed;
+        if(trialSaved)
+            journalSegmentTreeNode(j);
+        buildUnionLeaf(j, parts[changed]);
+        for(j/=2; j>=1; j/=2)
+        {
+            if(trialSaved)
+                journalSegmentTreeNode(j);
+            buildUnionNode(j);
+        }
+    }
+
+    monotoneChain(segmentTree[1], hullPoints_);
+    // last point equals first, this makes calculation of A and L easier
+    m_A = -1.;
+    m_L = -1.;
+}
+
+/// Builds leaf k of the union tree from the (hull) points of a part.
+template <class T>
+void ConvexHull<T>::buildUnionLeaf(int k, const std::vector<Step<T>> *part)
+{
+    std::vector<Step<T>> &node = segmentTree[k];
+    node.clear();
+    if(part == nullptr)
+        return;
+
+    node.assign(part->begin(), part->end());
+    std::sort(node.begin(), node.end());
+    sortedHullVertices(node);
+}
+
+/// Builds the inner node k of the union tree by merging its children.
+template <class T>
+void ConvexHull<T>::buildUnionNode(int k)
+{
+    const std::vector<Step<T>> &left = segmentTree[2*k];
+    const std::vector<Step<T>> &right = segmentTree[2*k+1];
+
+    std::vector<Step<T>> &node = segmentTree[k];
+    node.resize(left.size() + right.size());
+    std::merge(left.begin(), left.end(),
+               right.begin(), right.end(),
+               node.begin());
+    if(!left.empty() && !right.empty())
+        sortedHullVertices(node);
+}
+
+/** Starts a trial move.
+ *
+ * All following calls of run() or update() can be undone by
+ * rollback() until the trial is finished by commit() or the next
+ * beginTrial(). Instead of copying the hull, the state is swapped into
+ * a second slot on the first modification, such that the buffers are
+ * reused and a rollback is O(1). The segment tree only saves the nodes
+ * it rebuilds.
+ */
+template <class T>
+void ConvexHull<T>::beginTrial()
+{
+    commit();
+    trialActive = true;
+}
+
+/// Accepts the current trial move.
+template <class T>
+void ConvexHull<T>::commit()
+{
+    trialActive = false;
+    trialSaved = false;
+}
+
+/// Restores the state of the hull at the time of beginTrial().
+template <class T>
+void ConvexHull<T>::rollback()
+{
+    if(trialSaved)
+    {
+        if(trialJournalSize >= 0)
+        {
+            rollbackSegmentTreeJournal();
+            std::swap(m_A, saved.A);
+            std::swap(m_L, saved.L);
+            hullPoints_.swap(saved.hullPoints);
+            pointOffsets = saved.pointOffsets;
+            pointOffsetBlockSize = saved.pointOffsetBlockSize;
+        }
+        else
+        {
+            swapTrialState();
+        }
+    }
+    commit();
+}
+
+/// Saves the whole state before run() overwrites it.
+template <class T>
+void ConvexHull<T>::saveTrialState()
+{
+    if(trialSaved && trialJournalSize < 0)
+        return;
+
+    if(trialSaved)
+    {
+        // the segment tree was already modified, start from the original
+        rollback();
+        trialActive = true;
+    }
+
+    swapTrialState();
+    trialJournalSize = -1;
+    trialSaved = true;
+}
+
+/// Swaps the whole state with the second slot (or back).
+template <class T>
+void ConvexHull<T>::swapTrialState()
+{
+    std::swap(n, saved.n);
+    std::swap(d, saved.d);
+    std::swap(m_A, saved.A);
+    std::swap(m_L, saved.L);
+    std::swap(interiorPoints, saved.interiorPoints);
+    hullPoints_.swap(saved.hullPoints);
+    qhull.swap(saved.qhull);
+    coords.swap(saved.coords);
+    std::swap(zero_axis, saved.zero_axis);
+    std::swap(segmentTreeLeaves, saved.segmentTreeLeaves);
+    std::swap(unionParts, saved.unionParts);
+    segmentTreeLo.swap(saved.segmentTreeLo);
+    segmentTree.swap(saved.segmentTree);
+    std::swap(pointOffsets, saved.pointOffsets);
+    std::swap(pointOffsetBlockSize, saved.pointOffsetBlockSize);
+    hullTriangles.swap(saved.hullTriangles);
+}
+
+/// Saves node k of the segment tree before it is rebuilt.
+template <class T>
+void ConvexHull<T>::journalSegmentTreeNode(int k)
+{
+    if(trialJournalSize < 0)
+        return;
+
+    if(trialJournalSize == (int) trialJournal.size())
+        trialJournal.emplace_back();
+    trialJournal[trialJournalSize].first = k;
+    // the node is rebuilt from scratch, so we can reuse the old buffer
+    trialJournal[trialJournalSize].second.swap(segmentTree[k]);
+    ++trialJournalSize;
+}
+
+/// Restores all journaled nodes of the segment tree.
+template <class T>
+void ConvexHull<T>::rollbackSegmentTreeJournal()
+{
+    for(int i=trialJournalSize-1; i>=0; --i)
+        segmentTree[trialJournal[i].first].swap(trialJournal[i].second);
+    trialJournalSize = 0;
+}
+
 /** Set the points and reset all observables.
  *
  * This is a preparation function, which will be called by run().
@@ -145,6 +577,8 @@ void ConvexHull<T>::setPoints(std::vector<Step<T>> *points)
 
     n = interiorPoints->size();
     d = (*interiorPoints)[0].d();
+    pointOffsets = nullptr;
+    unionParts = -1;
 
     // reset all observalbes, else the lazy evaluation will possibly
     // yield the values of the last call
@@ -157,6 +591,8 @@ void ConvexHull<T>::setPoints(std::vector<Step<T>> *points)
 template <class T>
 void ConvexHull<T>::setHullAlgo(hull_algorithm_t alg)
 {
+    // a saved state of another algorithm can not be restored
+    commit();
     algorithm = alg;
 }
 
@@ -236,7 +672,8 @@ int ConvexHull<T>::num_vertices() const
     int c = hullPoints().size() - 1;
 
     // qhull does not list first and last twice
-    if(algorithm == CH_QHULL_AKL || algorithm == CH_QHULL)
+    if((algorithm == CH_QHULL_AKL || algorithm == CH_QHULL || algorithm == CH_QUICKHULL_3D)
+       && unionParts < 0)
         c++;
 
     return c;
@@ -246,7 +683,8 @@ int ConvexHull<T>::num_vertices() const
 template <class T>
 const std::vector<Step<T>>& ConvexHull<T>::hullPoints() const
 {
-    if(algorithm == CH_NOP || algorithm == CH_1D)
+    if(algorithm == CH_NOP || algorithm == CH_1D || algorithm == CH_SEGMENT_TREE
+       || algorithm == CH_QUICKHULL_3D)
         return hullPoints_;
     if(hullPoints_.empty())
         updateHullPoints();
@@ -558,6 +996,17 @@ std::vector<std::vector<Step<T>>> ConvexHull<T>::hullFacets() const
         throw std::invalid_argument("facets not well thought through for d>=4");
     }
 
+    if(algorithm == CH_QUICKHULL_3D)
+    {
+        std::vector<std::vector<Step<T>>> facets;
+        facets.reserve(hullTriangles.size());
+        for(const auto &t : hullTriangles)
+            facets.push_back({(*interiorPoints)[t[0]],
+                              (*interiorPoints)[t[1]],
+                              (*interiorPoints)[t[2]]});
+        return facets;
+    }
+
     orgQhull::QhullFacetList fl = qhull->facetList();
     std::vector<std::vector<Step<T>>> facets;
 
@@ -812,6 +1261,147 @@ void ConvexHull<T>::runAndrews()
     // last point equals first, this makes calculation of A and L easier
 }
 
+/// Uses all points as candidates for the algorithms working on pointSelection.
+template <class T>
+void ConvexHull<T>::selectAllPoints()
+{
+    pointSelection.resize(n);
+    for(int i=0; i<n; ++i)
+        pointSelection[i] = &(*interiorPoints)[i];
+}
+
+/** Graham's scan.
+ *
+ * The pivot is the lexicographically smallest point, such that the
+ * hull starts at the same vertex and runs counterclockwise like the
+ * one of runAndrews(). All other points are right of or above the
+ * pivot, i.e., their polar angles span less than 180 degrees and
+ * can be sorted by the sign of the cross product.
+ */
+template <class T>
+void ConvexHull<T>::runGraham()
+{
+    if(d != 2)
+    {
+        LOG(LOG_ERROR) << "Graham Scan does only work in a plane (d=2), the data is d = " << d;
+        throw std::invalid_argument("Graham Scan does only work in a plane (d=2)");
+    }
+
+    if(algorithm != CH_GRAHAM_AKL)
+        selectAllPoints();
+
+    auto pivot = std::min_element(pointSelection.begin(), pointSelection.end(),
+        [](const Step<T> *a, const Step<T> *b) -> bool
+        {
+            return *a < *b;
+        }
+    );
+    std::iter_swap(pointSelection.begin(), pivot);
+    const Step<T> &o = *pointSelection[0];
+
+    // monotone in the polar angle around o, a key and therefore a strict
+    // weak ordering, which the rounded cross product of doubles is not
+    auto pseudoAngle = [&o](const Step<T> *p) -> double
+    {
+        const T dx = p->x() - o.x();
+        const T dy = p->y() - o.y();
+        const T s = dx + std::abs(dy);
+        return s == 0 ? -2. : dy / (double) s;
+    };
+
+    std::sort(pointSelection.begin()+1, pointSelection.end(),
+        [&o, &pseudoAngle](const Step<T> *a, const Step<T> *b) -> bool
+        {
+            if(std::is_integral<T>::value)
+            {
+                const T c = cross2d_z(o, *a, *b);
+                if(c != 0)
+                    return c > 0;
+            }
+            else
+            {
+                const double ka = pseudoAngle(a);
+                const double kb = pseudoAngle(b);
+                if(ka != kb)
+                    return ka < kb;
+            }
+            // collinear with the pivot, nearer points first
+            return distance2d_squared(o, *a) < distance2d_squared(o, *b);
+        }
+    );
+
+    hullPointStack.clear();
+    for(int i=0; i<n; ++i)
+    {
+        while(hullPointStack.size() >= 2
+              && cross2d_z(*hullPointStack[hullPointStack.size()-2],
+                           *hullPointStack.back(),
+                           *pointSelection[i]) <= 0)
+            hullPointStack.pop_back();
+        hullPointStack.push_back(pointSelection[i]);
+    }
+
+    // last point equals first, like runAndrews()
+    hullPoints_.resize(hullPointStack.size() + 1);
+    for(size_t i=0; i<hullPointStack.size(); ++i)
+        hullPoints_[i] = *hullPointStack[i];
+    hullPoints_.back() = o;
+}
+
+/** Andrew's monotone chain for lattice walks without sorting.
+ *
+ * All x coordinates are integers in [minx, maxx], which is at most N
+ * wide. Only the lowest and highest point of every column can be on
+ * the hull and those candidates are already in lexicographic order,
+ * such that the construction is O(N + width) instead of O(N log N).
+ */
+template <class T>
+void ConvexHull<T>::runColumnExtrema()
+{
+    if(d != 2 || !std::is_integral<T>::value)
+    {
+        LOG(LOG_ERROR) << "Column extrema do only work for lattice walks in a plane (d=2), the data is d = " << d;
+        throw std::invalid_argument("Column extrema do only work for lattice walks in a plane (d=2)");
+    }
+
+    const std::vector<Step<T>> &p = *interiorPoints;
+
+    T minx = p[0].x(), maxx = p[0].x();
+    for(const auto &s : p)
+    {
+        if(s.x() < minx)
+            minx = s.x();
+        if(s.x() > maxx)
+            maxx = s.x();
+    }
+
+    const int width = maxx - minx + 1;
+    columnMin.assign(width, std::numeric_limits<T>::max());
+    columnMax.assign(width, std::numeric_limits<T>::lowest());
+    for(const auto &s : p)
+    {
+        const int c = s.x() - minx;
+        if(s.y() < columnMin[c])
+            columnMin[c] = s.y();
+        if(s.y() > columnMax[c])
+            columnMax[c] = s.y();
+    }
+
+    columnCandidates.clear();
+    for(int c=0; c<width; ++c)
+    {
+        // columns without points, only possible for unusual lattice walks
+        if(columnMin[c] > columnMax[c])
+            continue;
+        columnCandidates.push_back(Step<T>({(T) (minx + c), columnMin[c]}));
+        if(columnMax[c] != columnMin[c])
+            columnCandidates.push_back(Step<T>({(T) (minx + c), columnMax[c]}));
+    }
+
+    // last point equals first, like runAndrews()
+    monotoneChain(columnCandidates, hullPoints_);
+}
+
 template <class T>
 void ConvexHull<T>::runJarvis()
 {
@@ -886,38 +1476,686 @@ void ConvexHull<T>::runJarvis()
     // mind that first and last entry of hullPoints_ are the same
 }
 
-// this is the same andrews implementation as above, but as a pure function
-// TODO join this with the above implementation
+/** Monotone chain over points which are already sorted.
+ *
+ * Writes the closed counterclockwise hull (first equals last) into
+ * hull and returns the number of points on the lower hull.
+ */
 template <class T>
-std::vector<Step<T>> andrew(std::vector<Step<T>> &points)
+int ConvexHull<T>::monotoneChain(const std::vector<Step<T>> &sorted, std::vector<Step<T>> &hull)
 {
-    // sort points lexicographically
-    std::sort(points.begin(), points.end());
-
-    int n = points.size();
-    std::vector<Step<T>> hull(2*n);
+    const int m = sorted.size();
+    hull.resize(2*m);
 
     int k = 0;
     // Build lower hull
-    for(int i=0; i<n; ++i)
+    for(int i=0; i<m; ++i)
     {
-        while (k>=2 && cross2d_z(hull[k-2], hull[k-1], points[i]) <= 0)
+        while (k>=2 && cross2d_z(hull[k-2], hull[k-1], sorted[i]) <= 0)
             k--;
-        hull[k++] = points[i];
+        hull[k++] = sorted[i];
     }
+    const int lower = k;
 
     // Build upper hull
-    for(int i=n-2, t=k+1; i>=0; --i)
+    for(int i=m-2, t=k+1; i>=0; --i)
     {
-        while (k>=t && cross2d_z(hull[k-2], hull[k-1], points[i]) <= 0)
+        while (k>=t && cross2d_z(hull[k-2], hull[k-1], sorted[i]) <= 0)
             k--;
-        hull[k++] = points[i];
+        hull[k++] = sorted[i];
     }
 
     hull.resize(k);
-    return hull;
+    return lower;
 }
 
+/** Replaces the sorted points by the sorted vertices of their hull.
+ *
+ * The lower hull is already sorted and the upper hull is sorted in
+ * reverse order, such that both can be merged in linear time.
+ */
+template <class T>
+void ConvexHull<T>::sortedHullVertices(std::vector<Step<T>> &sorted)
+{
+    const int lower = monotoneChain(sorted, segmentTreeChain);
+    const std::vector<Step<T>> &hull = segmentTreeChain;
+
+    sorted.clear();
+    // the last point of the chain is the first again
+    int i = 0, j = (int) hull.size() - 2;
+    while(i < lower && j >= lower)
+    {
+        if(hull[j] < hull[i])
+            sorted.push_back(hull[j--]);
+        else
+            sorted.push_back(hull[i++]);
+    }
+    while(i < lower)
+        sorted.push_back(hull[i++]);
+    while(j >= lower)
+        sorted.push_back(hull[j--]);
+}
+
+/// Point i, including a pending translation passed to update().
+template <class T>
+Step<T> ConvexHull<T>::segmentTreePoint(int i) const
+{
+    if(pointOffsets == nullptr)
+        return (*interiorPoints)[i];
+    return (*interiorPoints)[i] + (*pointOffsets)[i / pointOffsetBlockSize];
+}
+
+/** Builds leaf k of the segment tree.
+ *
+ * Every node stores the sorted vertices of the hull of a contiguous
+ * range of points, relative to the first point of its range. A change
+ * of a step translates all following points by the same vector, which
+ * leaves every node right of the change untouched, i.e., the
+ * translation is applied lazily while merging the parent.
+ */
+template <class T>
+void ConvexHull<T>::buildSegmentTreeLeaf(int k)
+{
+    const int lo = segmentTreeLo[k];
+    const int hi = std::min(lo + segmentTreeLeafSize, n);
+
+    std::vector<Step<T>> &node = segmentTree[k];
+    node.clear();
+    if(lo >= hi)
+        return;
+
+    const Step<T> origin = segmentTreePoint(lo);
+    for(int i=lo; i<hi; ++i)
+        node.push_back(segmentTreePoint(i) - origin);
+
+    std::sort(node.begin(), node.end());
+    sortedHullVertices(node);
+}
+
+/// Builds the inner node k of the segment tree by merging its children.
+template <class T>
+void ConvexHull<T>::buildSegmentTreeNode(int k)
+{
+    const std::vector<Step<T>> &left = segmentTree[2*k];
+    const std::vector<Step<T>> &right = segmentTree[2*k+1];
+
+    if(right.empty())
+    {
+        segmentTree[k] = left;
+        return;
+    }
+
+    // the right child is relative to its own first point
+    const Step<T> offset = segmentTreePoint(segmentTreeLo[2*k+1]) - segmentTreePoint(segmentTreeLo[k]);
+    segmentTreeBuffer.clear();
+    for(const auto &s : right)
+        segmentTreeBuffer.push_back(s + offset);
+
+    std::vector<Step<T>> &node = segmentTree[k];
+    node.resize(left.size() + right.size());
+    std::merge(left.begin(), left.end(),
+               segmentTreeBuffer.begin(), segmentTreeBuffer.end(),
+               node.begin());
+    sortedHullVertices(node);
+}
+
+/** Builds the segment tree of partial hulls from scratch.
+ *
+ * The leaves are blocks of segmentTreeLeafSize consecutive points and
+ * the tree is a perfect binary tree stored as an implicit heap.
+ */
+template <class T>
+void ConvexHull<T>::runSegmentTree()
+{
+    if(d != 2)
+    {
+        LOG(LOG_ERROR) << "The segment tree does only work in a plane (d=2), the data is d = " << d;
+        throw std::invalid_argument("The segment tree does only work in a plane (d=2)");
+    }
+
+    const int blocks = (n + segmentTreeLeafSize - 1) / segmentTreeLeafSize;
+    segmentTreeLeaves = 1;
+    while(segmentTreeLeaves < blocks)
+        segmentTreeLeaves *= 2;
+
+    segmentTree.resize(2*segmentTreeLeaves);
+    segmentTreeLo.resize(2*segmentTreeLeaves);
+    for(int j=0; j<segmentTreeLeaves; ++j)
+        segmentTreeLo[segmentTreeLeaves + j] = std::min(j * segmentTreeLeafSize, n);
+    for(int k=segmentTreeLeaves-1; k>=1; --k)
+        segmentTreeLo[k] = segmentTreeLo[2*k];
+
+    for(int k=segmentTreeLeaves; k<2*segmentTreeLeaves; ++k)
+        buildSegmentTreeLeaf(k);
+    for(int k=segmentTreeLeaves-1; k>=1; --k)
+        buildSegmentTreeNode(k);
+
+    updateSegmentTree(0, -1);
+}
+
+/** Rebuilds all nodes which contain a changed step and the root hull.
+ *
+ * Step i connects point i and i+1, so only the leaves containing the
+ * points firstStep+1 to lastStep+1 and their ancestors are affected.
+ */
+template <class T>
+void ConvexHull<T>::updateSegmentTree(int firstStep, int lastStep)
+{
+    if(firstStep <= lastStep)
+    {
+        int a = segmentTreeLeaves + (firstStep+1) / segmentTreeLeafSize;
+        int b = segmentTreeLeaves + std::min(lastStep+1, n-1) / segmentTreeLeafSize;
+        for(int k=a; k<=b; ++k)
+        {
+            if(trialSaved)
+                journalSegmentTreeNode(k);
+            buildSegmentTreeLeaf(k);
+        }
+        for(a/=2, b/=2; a>=1; a/=2, b/=2)
+            for(int k=a; k<=b; ++k)
+            {
+                if(trialSaved)
+                    journalSegmentTreeNode(k);
+                buildSegmentTreeNode(k);
+            }
+    }
+
+    // the root is relative to the first point
+    monotoneChain(segmentTree[1], segmentTreeChain);
+    const Step<T> origin = segmentTreePoint(0);
+    hullPoints_.resize(segmentTreeChain.size());
+    for(size_t i=0; i<segmentTreeChain.size(); ++i)
+        hullPoints_[i] = segmentTreeChain[i] + origin;
+    // last point equals first, this makes calculation of A and L easier
+}
+
+/** Native quickhull in d=3.
+ *
+ * Works directly on the points, i.e., without copying them into a
+ * buffer and constructing a Qhull object for every call. All buffers
+ * are kept between calls. The decisions are made with the exact
+ * orientation3d() predicate, such that the many coplanar and
+ * collinear points of lattice walks need no special treatment.
+ * Coplanar faces are not merged, the hull is a triangulation.
+ */
+template <class T>
+void ConvexHull<T>::runQuickhull3D()
+{
+    if(d != 3)
+    {
+        LOG(LOG_ERROR) << "the native Quickhull does only work in d=3, the data is d = " << d;
+        throw std::invalid_argument("the native Quickhull does only work in d=3");
+    }
+
+    typedef typename exact_t<T>::type E;
+    const std::vector<Step<T>> &p = *interiorPoints;
+
+    numFaces3d = 0;
+    visitMark3d = 0;
+    hullTriangles.clear();
+
+    // initial simplex: the lexicographically smallest point, the point
+    // furthest away from it, the point furthest from the line through
+    // both and the point furthest from the plane through all three
+    int i0 = 0;
+    for(int i=1; i<n; ++i)
+        if(p[i] < p[i0])
+            i0 = i;
+
+    int i1 = i0;
+    E maxDist = 0;
+    for(int i=0; i<n; ++i)
+    {
+        E dist = 0;
+        for(int j=0; j<3; ++j)
+            dist += (E) (p[i][j] - p[i0][j]) * (p[i][j] - p[i0][j]);
+        if(dist > maxDist)
+        {
+            maxDist = dist;
+            i1 = i;
+        }
+    }
+
+    if(maxDist == 0)
+    {
+        LOG(LOG_DEBUG) << "all points are identical";
+        m_A = 0;
+        m_L = 0;
+        hullPoints_.push_back(p[i0]);
+        return;
+    }
+
+    const E ux = p[i1].x() - p[i0].x();
+    const E uy = p[i1].y() - p[i0].y();
+    const E uz = p[i1].z() - p[i0].z();
+    int i2 = i0;
+    double maxArea = 0;
+    for(int i=0; i<n; ++i)
+    {
+        const E wx = p[i].x() - p[i0].x();
+        const E wy = p[i].y() - p[i0].y();
+        const E wz = p[i].z() - p[i0].z();
+        const double cx = uy*wz - uz*wy;
+        const double cy = uz*wx - ux*wz;
+        const double cz = ux*wy - uy*wx;
+        const double area = cx*cx + cy*cy + cz*cz;
+        if(area > maxArea)
+        {
+            maxArea = area;
+            i2 = i;
+        }
+    }
+
+    if(maxArea == 0)
+    {
+        LOG(LOG_DEBUG) << "all points are collinear";
+        m_A = 0;
+        m_L = 0;
+        hullPoints_.push_back(p[i0]);
+        hullPoints_.push_back(p[i1]);
+        return;
+    }
+
+    int i3 = i0;
+    E maxVolume = 0;
+    for(int i=0; i<n; ++i)
+    {
+        E volume = orientation3d(p[i0], p[i1], p[i2], p[i]);
+        if(volume < 0)
+            volume = -volume;
+        if(volume > maxVolume)
+        {
+            maxVolume = volume;
+            i3 = i;
+        }
+    }
+
+    if(maxVolume == 0)
+    {
+        LOG(LOG_DEBUG) << "all points are coplanar";
+        planarHull3D(i0, i1, i2);
+        return;
+    }
+
+    // orient the tetrahedron such that all normals point outwards
+    if(orientation3d(p[i0], p[i1], p[i2], p[i3]) > 0)
+        std::swap(i1, i2);
+    addFace3D(i0, i1, i2);
+    addFace3D(i0, i3, i1);
+    addFace3D(i1, i3, i2);
+    addFace3D(i2, i3, i0);
+    for(int f=0; f<4; ++f)
+        for(int k=0; k<3; ++k)
+            for(int g=0; g<4; ++g)
+                for(int l=0; l<3; ++l)
+                    if(faces3d[g].v[l] == faces3d[f].v[(k+1)%3]
+                       && faces3d[g].v[(l+1)%3] == faces3d[f].v[k])
+                        faces3d[f].neighbor[k] = g;
+
+    for(int i=0; i<n; ++i)
+        for(int f=0; f<4; ++f)
+            if(faceOrientation3D(f, i) > 0)
+            {
+                faces3d[f].outside.push_back(i);
+                break;
+            }
+
+    if(faceStartingAt3d.size() < (size_t) n)
+        faceStartingAt3d.resize(n);
+
+    faceStack3d.clear();
+    for(int f=0; f<4; ++f)
+        faceStack3d.push_back(f);
+
+    while(!faceStack3d.empty())
+    {
+        const int f = faceStack3d.back();
+        faceStack3d.pop_back();
+        if(!faces3d[f].alive || faces3d[f].outside.empty())
+            continue;
+
+        // the point furthest above the face is a vertex of the hull
+        int eye = -1;
+        E height = 0;
+        for(int i : faces3d[f].outside)
+        {
+            E h = faceOrientation3D(f, i);
+            if(h > height)
+            {
+                height = h;
+                eye = i;
+            }
+        }
+
+        // find all faces visible from the eye and the horizon around them
+        ++visitMark3d;
+        visibleFaces3d.clear();
+        horizon3d.clear();
+        faces3d[f].visited = visitMark3d;
+        faces3d[f].visible = true;
+        visibleFaces3d.push_back(f);
+        for(size_t j=0; j<visibleFaces3d.size(); ++j)
+        {
+            const int g = visibleFaces3d[j];
+            for(int k=0; k<3; ++k)
+            {
+                const int h = faces3d[g].neighbor[k];
+                if(faces3d[h].visited != visitMark3d)
+                {
+                    faces3d[h].visited = visitMark3d;
+                    faces3d[h].visible = faceOrientation3D(h, eye) > 0;
+                    if(faces3d[h].visible)
+                        visibleFaces3d.push_back(h);
+                }
+                if(!faces3d[h].visible)
+                    horizon3d.emplace_back(g, k);
+            }
+        }
+
+        // connect every edge of the horizon with the eye
+        newFaces3d.clear();
+        for(const auto &e : horizon3d)
+        {
+            const int g = e.first;
+            const int a = faces3d[g].v[e.second];
+            const int b = faces3d[g].v[(e.second+1)%3];
+            const int h = faces3d[g].neighbor[e.second];
+            const int nf = addFace3D(a, b, eye);
+
+            faces3d[nf].neighbor[0] = h;
+            for(int l=0; l<3; ++l)
+                if(faces3d[h].v[l] == b && faces3d[h].v[(l+1)%3] == a)
+                    faces3d[h].neighbor[l] = nf;
+            faceStartingAt3d[a] = nf;
+            newFaces3d.push_back(nf);
+        }
+        for(int nf : newFaces3d)
+        {
+            const int m = faceStartingAt3d[faces3d[nf].v[1]];
+            faces3d[nf].neighbor[1] = m;
+            faces3d[m].neighbor[2] = nf;
+        }
+
+        // points above the removed faces are either inside now
+        // or above one of the new faces
+        for(int g : visibleFaces3d)
+        {
+            for(int i : faces3d[g].outside)
+            {
+                if(i == eye)
+                    continue;
+                for(int nf : newFaces3d)
+                    if(faceOrientation3D(nf, i) > 0)
+                    {
+                        faces3d[nf].outside.push_back(i);
+                        break;
+                    }
+            }
+            faces3d[g].outside.clear();
+            faces3d[g].alive = false;
+        }
+
+        for(int nf : newFaces3d)
+            if(!faces3d[nf].outside.empty())
+                faceStack3d.push_back(nf);
+    }
+
+    // volume and surface area of the triangulation
+    E volume = 0;
+    double area = 0;
+    for(int f=0; f<numFaces3d; ++f)
+    {
+        if(!faces3d[f].alive)
+            continue;
+
+        const Step<T> &a = p[faces3d[f].v[0]];
+        const Step<T> &b = p[faces3d[f].v[1]];
+        const Step<T> &c = p[faces3d[f].v[2]];
+        hullTriangles.push_back({{faces3d[f].v[0], faces3d[f].v[1], faces3d[f].v[2]}});
+
+        volume -= orientation3d(a, b, c, p[i0]);
+
+        const E bx = b.x() - a.x(), by = b.y() - a.y(), bz = b.z() - a.z();
+        const E cx = c.x() - a.x(), cy = c.y() - a.y(), cz = c.z() - a.z();
+        const double nx = by*cz - bz*cy;
+        const double ny = bz*cx - bx*cz;
+        const double nz = bx*cy - by*cx;
+        area += std::sqrt(nx*nx + ny*ny + nz*nz);
+    }
+    m_A = volume / 6.;
+    m_L = area / 2.;
+
+    extremeVertices3D();
+}
+
+/** Hull of coplanar points in d=3.
+ *
+ * The hull is a polygon, its area is reported as surface area, like
+ * Qhull does for lattice walks confined to a plane. The polygon is
+ * calculated by Andrew's monotone chain in the projection onto the
+ * coordinate plane most parallel to the points.
+ */
+template <class T>
+void ConvexHull<T>::planarHull3D(int i0, int i1, int i2)
+{
+    typedef typename exact_t<T>::type E;
+    const std::vector<Step<T>> &p = *interiorPoints;
+
+    E normal[3];
+    {
+        const E bx = p[i1].x() - p[i0].x(), by = p[i1].y() - p[i0].y(), bz = p[i1].z() - p[i0].z();
+        const E cx = p[i2].x() - p[i0].x(), cy = p[i2].y() - p[i0].y(), cz = p[i2].z() - p[i0].z();
+        normal[0] = by*cz - bz*cy;
+        normal[1] = bz*cx - bx*cz;
+        normal[2] = bx*cy - by*cx;
+    }
+    int axis = 0;
+    for(int j=1; j<3; ++j)
+        if(std::abs((double) normal[j]) > std::abs((double) normal[axis]))
+            axis = j;
+    const int u = (axis+1) % 3;
+    const int v = (axis+2) % 3;
+
+    pointOrder3d.resize(n);
+    for(int i=0; i<n; ++i)
+        pointOrder3d[i] = i;
+    std::sort(pointOrder3d.begin(), pointOrder3d.end(),
+        [&p, u, v](int a, int b) -> bool
+        {
+            return p[a][u] < p[b][u] || (p[a][u] == p[b][u] && p[a][v] < p[b][v]);
+        }
+    );
+
+    auto turn = [&p, u, v](int o, int a, int b) -> E
+    {
+        return (E) (p[a][u] - p[o][u]) * (p[b][v] - p[o][v])
+             - (E) (p[a][v] - p[o][v]) * (p[b][u] - p[o][u]);
+    };
+
+    std::vector<int> &chain = faceStack3d;
+    chain.resize(2*n);
+    int k = 0;
+    for(int i=0; i<n; ++i)
+    {
+        while(k >= 2 && turn(chain[k-2], chain[k-1], pointOrder3d[i]) <= 0)
+            k--;
+        chain[k++] = pointOrder3d[i];
+    }
+    for(int i=n-2, t=k+1; i>=0; --i)
+    {
+        while(k >= t && turn(chain[k-2], chain[k-1], pointOrder3d[i]) <= 0)
+            k--;
+        chain[k++] = pointOrder3d[i];
+    }
+    // the first point is repeated at the end
+    --k;
+
+    E area2 = 0;
+    for(int i=0; i<k; ++i)
+    {
+        hullPoints_.push_back(p[chain[i]]);
+        area2 += turn(chain[0], chain[i], chain[(i+1) % k]);
+        if(i >= 2)
+            hullTriangles.push_back({{chain[0], chain[i-1], chain[i]}});
+    }
+
+    double norm = 0;
+    for(int j=0; j<3; ++j)
+        norm += (double) normal[j] * normal[j];
+
+    m_A = 0;
+    m_L = area2 / 2. * std::sqrt(norm) / std::abs((double) normal[axis]);
+    chain.clear();
+}
+
+/** Collects the vertices of the triangulation, which are vertices of
+ * the hull, into hullPoints_.
+ *
+ * A vertex of the triangulation is not a vertex of the hull, if it
+ * lies inside a facet, i.e., all its triangles are coplanar, or on an
+ * edge, i.e., between two of its neighbours.
+ */
+template <class T>
+void ConvexHull<T>::extremeVertices3D()
+{
+    typedef typename exact_t<T>::type E;
+    const std::vector<Step<T>> &p = *interiorPoints;
+
+    incidence3d.clear();
+    for(size_t t=0; t<hullTriangles.size(); ++t)
+        for(int k=0; k<3; ++k)
+            incidence3d.emplace_back(hullTriangles[t][k], t);
+    std::sort(incidence3d.begin(), incidence3d.end());
+
+    std::vector<int> &neighbors = faceStack3d;
+    for(size_t s=0, e=0; s<incidence3d.size(); s=e)
+    {
+        const int v = incidence3d[s].first;
+        neighbors.clear();
+        for(e=s; e<incidence3d.size() && incidence3d[e].first == v; ++e)
+            for(int k=0; k<3; ++k)
+                if(hullTriangles[incidence3d[e].second][k] != v)
+                    neighbors.push_back(hullTriangles[incidence3d[e].second][k]);
+
+        const auto &t0 = hullTriangles[incidence3d[s].second];
+        bool extreme = false;
+        for(int u : neighbors)
+            if(orientation3d(p[t0[0]], p[t0[1]], p[t0[2]], p[u]) != 0)
+                extreme = true;
+
+        for(size_t a=0; extreme && a<neighbors.size(); ++a)
+            for(size_t b=a+1; extreme && b<neighbors.size(); ++b)
+            {
+                E x[3], y[3];
+                for(int j=0; j<3; ++j)
+                {
+                    x[j] = p[neighbors[a]][j] - p[v][j];
+                    y[j] = p[neighbors[b]][j] - p[v][j];
+                }
+                const bool collinear = x[1]*y[2] == x[2]*y[1]
+                                    && x[2]*y[0] == x[0]*y[2]
+                                    && x[0]*y[1] == x[1]*y[0];
+                if(collinear && x[0]*y[0] + x[1]*y[1] + x[2]*y[2] < 0)
+                    extreme = false;
+            }
+
+        if(extreme)
+            hullPoints_.push_back(p[v]);
+    }
+    neighbors.clear();
+}
+
+/// Adds a living face with the vertices a, b, c, reusing old buffers.
+template <class T>
+int ConvexHull<T>::addFace3D(int a, int b, int c)
+{
+    if(numFaces3d == (int) faces3d.size())
+        faces3d.emplace_back();
+
+    Face3D &f = faces3d[numFaces3d];
+    f.v[0] = a;
+    f.v[1] = b;
+    f.v[2] = c;
+    f.visited = 0;
+    f.visible = false;
+    f.alive = true;
+    f.outside.clear();
+
+    return numFaces3d++;
+}
+
+/// Positive, if point i is above face f.
+template <class T>
+typename exact_t<T>::type ConvexHull<T>::faceOrientation3D(int f, int i) const
+{
+    const std::vector<Step<T>> &p = *interiorPoints;
+    return orientation3d(p[faces3d[f].v[0]], p[faces3d[f].v[1]], p[faces3d[f].v[2]], p[i]);
+}
+
+/// True, if b is a better next vertex than a for a counterclockwise gift wrap from p.
+template <class T>
+bool ConvexHull<T>::wrapsFurther(const Step<T> &p, const Step<T> &a, const Step<T> &b)
+{
+    const T c = cross2d_z(p, a, b);
+    return c < 0 || (c == 0 && distance2d_squared(p, b) > distance2d_squared(p, a));
+}
+
+/** Splits the candidates into groups of at most m points and
+ * calculates their hulls with Andrew's monotone chain.
+ *
+ * The sub hulls are counterclockwise without the closing point and
+ * stored consecutively in chanHulls, such that no allocations are
+ * necessary once the buffers have grown.
+ */
+template <class T>
+void ConvexHull<T>::chanSubHulls(int m)
+{
+    const int groups = (n + m - 1) / m;
+    chanHulls.resize(2*n);
+    chanHullStart.resize(groups + 1);
+
+    int out = 0;
+    for(int g=0; g<groups; ++g)
+    {
+        Step<T> **first = pointSelection.data() + g*m;
+        const int len = std::min(n, (g+1)*m) - g*m;
+        std::sort(first, first + len,
+            [](const Step<T> *a, const Step<T> *b) -> bool
+            {
+                return *a < *b;
+            }
+        );
+
+        // the group starts at most at g*m, so there is room for 2*len points
+        Step<T> **h = chanHulls.data() + out;
+        int k = 0;
+        for(int i=0; i<len; ++i)
+        {
+            while (k>=2 && cross2d_z(*h[k-2], *h[k-1], *first[i]) <= 0)
+                k--;
+            h[k++] = first[i];
+        }
+        for(int i=len-2, t=k+1; i>=0; --i)
+        {
+            while (k>=t && cross2d_z(*h[k-2], *h[k-1], *first[i]) <= 0)
+                k--;
+            h[k++] = first[i];
+        }
+
+        chanHullStart[g] = out;
+        out += k > 1 ? k-1 : k;
+    }
+    chanHullStart[groups] = out;
+}
+
+/** Chan's algorithm, output sensitive in O(n log h).
+ *
+ * Jarvis' march over the hulls of groups of m points. Every sub hull
+ * keeps the index of its tangent point. Since the march proceeds
+ * counterclockwise, the tangent points do so as well and one march
+ * costs O(n/m h + n) instead of O(n h). If the hull has more than m
+ * vertices, the march is aborted and repeated with m squared.
+ */
 template <class T>
 void ConvexHull<T>::runChan()
 {
@@ -932,56 +2170,55 @@ void ConvexHull<T>::runChan()
         throw std::invalid_argument("Chan's Algorithm is only implemented in d=2");
     }
 
-    int n = interiorPoints->size();
-    int m = 100;
-    std::vector<Step<T>> hull;
-    while(true)
+    if(algorithm != CH_CHAN_AKL)
+        selectAllPoints();
+
+    // the lexicographically smallest point is on the hull
+    Step<T> *start = *std::min_element(pointSelection.begin(), pointSelection.end(),
+        [](const Step<T> *a, const Step<T> *b) -> bool
+        {
+            return *a < *b;
+        }
+    );
+
+    for(int t=1; ; ++t)
     {
-        int k = n/m + 1;
-        // split point set in n/m sub sets of size <= m
-        auto subsets = std::vector<std::vector<Step<T>>>(k);
-        for(int i=0; i<n; ++i)
-            subsets[i%k].push_back((*interiorPoints)[i]);
-
-        // calculate the sub-hulls with Andrew's algorithm
-        // the implementation above is f***ed up, just reimplement it :/
-        auto subhulls = std::vector<std::vector<Step<T>>>(k);
-        for(int i=0; i<k; ++i)
-            subhulls[i] = andrew(subsets[i]);
-
-        // perform Jarvis' march with only the tangent points
-        // find p1: leftmost point
-        Step<T> p1 = std::min(*interiorPoints);
-        Step<T> q = p1;
-        hull.push_back(p1);
+        // m = 2^(2^t), but at most n
+        const int m = t < 5 ? std::min(n, 1 << (1 << t)) : n;
+        chanSubHulls(m);
+        const int groups = chanHullStart.size() - 1;
+        chanTangent.assign(groups, 0);
+
+        hullPointStack.clear();
+        hullPointStack.push_back(start);
+        const Step<T> *p = start;
         for(int i=0; i<m; ++i)
         {
-            for(auto j=0; j<k; ++j)
+            Step<T> *q = nullptr;
+            for(int g=0; g<groups; ++g)
             {
-                Step<T> t = polygon_tangent(hull[i], subhulls[j]);
-
-                T orientation = cross2d_z(hull[i], t, q);
-                if(orientation > 0)
-                    q = t;
-                else if(orientation == 0) // colinear
-                {
-                    // take the one furthest away
-                    if((q-hull[i]).length() < (t-hull[i]).length())
-                        q = t;
-                }
+                Step<T> **h = chanHulls.data() + chanHullStart[g];
+                const int s = chanHullStart[g+1] - chanHullStart[g];
+                int &j = chanTangent[g];
+                for(int c=0; c<s && wrapsFurther(*p, *h[j], *h[(j+1) % s]); ++c)
+                    j = (j+1) % s;
+
+                if(q == nullptr || wrapsFurther(*p, *q, *h[j]))
+                    q = h[j];
             }
-            hull.push_back(q);
 
-            // if we are finished after <= m iterations, we found the hull
-            if(q == p1)
+            if(*q == *start)
             {
-                hullPoints_ = hull;
+                // last point equals first, like runAndrews()
+                hullPoints_.resize(hullPointStack.size() + 1);
+                for(size_t k=0; k<hullPointStack.size(); ++k)
+                    hullPoints_[k] = *hullPointStack[k];
+                hullPoints_.back() = *start;
                 return;
             }
+            hullPointStack.push_back(q);
+            p = q;
         }
-
-        m = m*m;
-        hull.clear();
     }
 }
 
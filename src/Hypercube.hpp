@@ -2,25 +2,10 @@
 #define HYPERCUBE_H
 
 #include <vector>
-#include <cmath>
-#include <deque>
-#include <unordered_set>
-#include <unordered_map>
 #include <algorithm>
-#include <queue>
 
 #include "Step.hpp"
-
-/// class implementing a best first search assuming a hypercubic graph
-class Hypercube
-{
-    public:
-        Hypercube() {}
-
-        template<class T>
-        bool bestfs(Step<int> source, Step<int> target, T& occupied);
-
-};
+#include "LatticeMap.hpp"
 
 /// helper structure for the best first search
 /// elements on the heap will have this type
@@ -34,42 +19,62 @@ struct CandidateStep {
     }
 };
 
+/** class implementing a best first search assuming a hypercubic graph
+ *
+ * The heap and the visited sites are kept between searches, such that
+ * one instance can be used for many searches without allocating.
+ */
+class Hypercube
+{
+    public:
+        Hypercube() {}
+
+        template<class T>
+        bool bestfs(const Step<int> &source, const Step<int> &target, const T& occupied);
+
+    protected:
+        std::vector<CandidateStep> heap;
+        LatticeMap<char> visited;
+};
+
 template<class T>
-bool Hypercube::bestfs(Step<int> source, Step<int> target, T& occupied)
+bool Hypercube::bestfs(const Step<int> &source, const Step<int> &target, const T& occupied)
 {
-    std::priority_queue<CandidateStep> q;
-    std::unordered_set<Step<int>> visited;
+    heap.clear();
+    visited.clear();
 
-    q.emplace(source, target.dist(source));
+    heap.emplace_back(source, target.dist(source));
 
-    while(!q.empty())
+    Step<int> n(source.d());
+    while(!heap.empty())
     {
-        Step<int> c = q.top().value;
-        q.pop();
+        std::pop_heap(heap.begin(), heap.end());
+        const Step<int> c = heap.back().value;
+        heap.pop_back();
 
-        double D = target.dist(c);
+        int D = target.dist(c);
         if(c == target)
         {
             return true;
         }
-        for(auto i : c.neighbors())
-        {
-            if(!visited.count(i) && !occupied.count(i))
+        for(int axis=0; axis<c.d(); ++axis)
+            for(int direction=1; direction>=-1; direction-=2)
             {
-                visited.insert(i);
-                double d = target.dist(i);
-                if(d < D)
-                {
-                    q.emplace(c, D);
-                    q.emplace(i, d);
+                n = c;
+                n[axis] += direction;
+                if(visited.count(n) || occupied.count(n))
                     continue;
-                }
-                else
+
+                visited.insert(n, 1);
+                int d = target.dist(n);
+                if(d < D)
                 {
-                    q.emplace(i, d);
+                    heap.emplace_back(c, D);
+                    std::push_heap(heap.begin(), heap.end());
                 }
+                heap.emplace_back(n, d);
+                std::push_heap(heap.begin(), heap.end());
             }
-        }
     }
     return false;
 }
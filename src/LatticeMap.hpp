@@ -0,0 +1,426 @@
+#ifndef LATTICEMAP_H
+#define LATTICEMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "Step.hpp"
+
+/** Map from lattice sites to values, meant to be kept alive.
+ *
+ * As long as the sites are dense enough, the values are stored in a
+ * flat array over the bounding box of all sites, which grows by
+ * doubling in every direction, where it is too small. If the box
+ * would become much larger than the number of entries, the map
+ * switches for good to a hash table with open addressing and linear
+ * probing, mixing the coordinates packed into 64 bits.
+ * Both are a lot faster than the buckets of a std::unordered_map with
+ * the xor of std::hash<Step<int>>.
+ *
+ * clear() is O(1) by invalidating all entries with a new stamp and
+ * keeps the box or table, such that one instance can be reused for
+ * many walks without allocating.
+ *
+ * Pointers returned by find() are valid until the next insertion or
+ * erase().
+ *
+ * \tparam V type of the values
+ */
+template<class V>
+class LatticeMap
+{
+    public:
+        LatticeMap()
+            : m_size(0),
+              m_stamp(1),
+              m_dense(true)
+        {
+            reserve(16);
+        }
+
+        void reserve(size_t n);
+        void clear();
+        size_t size() const { return m_size; }
+        bool dense() const { return m_dense; }
+
+        bool count(const Step<int> &p) const { return find(p) != nullptr; }
+        V* find(const Step<int> &p);
+        const V* find(const Step<int> &p) const;
+        V& operator[](const Step<int> &p);
+        bool insert(const Step<int> &p, const V &value);
+        bool erase(const Step<int> &p);
+
+    protected:
+        struct Slot
+        {
+            Slot() : stamp(0) {}
+            Step<int> key;
+            V value;
+            uint32_t stamp; ///< the slot is used, if it equals m_stamp, 0 is never used
+        };
+
+        struct Cell
+        {
+            Cell() : stamp(0) {}
+            V value;
+            uint32_t stamp; ///< the cell is used, if it equals m_stamp
+        };
+
+        static uint64_t hash(const Step<int> &p);
+        size_t find_slot(const Step<int> &p) const;
+        void grow();
+
+        long cell_index(const Step<int> &p) const;
+        void grow_box(const Step<int> &p);
+        void to_hash();
+
+        std::vector<Slot> slots;
+        size_t mask;
+
+        std::vector<Cell> cells;
+        Step<int> lo;       ///< lower corner of the box
+        Step<int> extent;   ///< side lengths of the box
+
+        size_t m_size;
+        uint32_t m_stamp;
+        bool m_dense;
+};
+
+/// packs the coordinates into 64 bits and mixes them with the finalizer of splitmix64
+template<class V>
+uint64_t LatticeMap<V>::hash(const Step<int> &p)
+{
+    const int bits = std::min(32, 64 / p.d());
+    uint64_t h = 0;
+    for(int i=0; i<p.d(); ++i)
+        h = (h << bits) ^ (uint32_t) p[i];
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+/// index of the slot of p, or of the empty slot where p belongs
+template<class V>
+size_t LatticeMap<V>::find_slot(const Step<int> &p) const
+{
+    size_t i = hash(p) & mask;
+    while(slots[i].stamp == m_stamp && !(slots[i].key == p))
+        i = (i + 1) & mask;
+    return i;
+}
+
+/// make room for n entries in the hash table without rehashing
+template<class V>
+void LatticeMap<V>::reserve(size_t n)
+{
+    size_t capacity = 16;
+    // keep the load factor below 1/2
+    while(capacity < 2*n)
+        capacity *= 2;
+    if(capacity <= slots.size())
+        return;
+
+    std::vector<Slot> old;
+    old.swap(slots);
+
+    slots.resize(capacity);
+    mask = capacity - 1;
+    if(m_dense)
+        return;
+
+    // the old entries are valid with the current stamp
+    m_size = 0;
+    for(const auto &s : old)
+        if(s.stamp == m_stamp)
+            insert(s.key, s.value);
+}
+
+template<class V>
+void LatticeMap<V>::grow()
+{
+    reserve(slots.size());
+}
+
+template<class V>
+void LatticeMap<V>::clear()
+{
+    m_size = 0;
+    ++m_stamp;
+    // after a wrap around old stamps would be valid again
+    if(m_stamp == 0)
+    {
+        for(auto &s : slots)
+            s.stamp = 0;
+        for(auto &c : cells)
+            c.stamp = 0;
+        m_stamp = 1;
+    }
+}
+
+/// index of the cell of p, or -1 if p is outside of the box
+template<class V>
+long LatticeMap<V>::cell_index(const Step<int> &p) const
+{
+    if(cells.empty())
+        return -1;
+
+    long idx = 0;
+    for(int i=p.d()-1; i>=0; --i)
+    {
+        const int x = p[i] - lo[i];
+        if(x < 0 || x >= extent[i])
+            return -1;
+        idx = idx * extent[i] + x;
+    }
+    return idx;
+}
+
+/** Enlarges the box, such that it contains p.
+ *
+ * Every side, which is too short, is doubled in the direction of p.
+ * If the box gets too sparse, all entries are moved to the hash table.
+ */
+template<class V>
+void LatticeMap<V>::grow_box(const Step<int> &p)
+{
+    const int d = p.d();
+    Step<int> new_lo(d);
+    Step<int> new_extent(d);
+    if(cells.empty())
+    {
+        for(int i=0; i<d; ++i)
+        {
+            new_extent[i] = d > 2 ? 8 : 32;
+            new_lo[i] = p[i] - new_extent[i] / 2;
+        }
+    }
+    else
+    {
+        new_lo = lo;
+        new_extent = extent;
+        for(int i=0; i<d; ++i)
+        {
+            if(p[i] < lo[i])
+            {
+                new_lo[i] = std::min(p[i], lo[i] - extent[i]);
+                new_extent[i] += lo[i] - new_lo[i];
+            }
+            else if(p[i] >= lo[i] + extent[i])
+                new_extent[i] = std::max(p[i] - lo[i] + 1, 2*extent[i]);
+        }
+    }
+
+    // allow a box of 16 cells per entry, but at least 2^16 cells
+    double volume = 1;
+    for(int i=0; i<d; ++i)
+        volume *= new_extent[i];
+    if(volume > std::max(65536., 16. * (m_size + 1)))
+    {
+        to_hash();
+        return;
+    }
+
+    std::vector<Cell> old;
+    old.swap(cells);
+    const Step<int> old_lo = lo;
+    const Step<int> old_extent = extent;
+
+    cells.resize((size_t) volume);
+    lo = new_lo;
+    extent = new_extent;
+
+    Step<int> q(d);
+    for(size_t idx=0; idx<old.size(); ++idx)
+    {
+        if(old[idx].stamp != m_stamp)
+            continue;
+        size_t rest = idx;
+        for(int i=0; i<d; ++i)
+        {
+            q[i] = old_lo[i] + rest % old_extent[i];
+            rest /= old_extent[i];
+        }
+        cells[cell_index(q)] = old[idx];
+    }
+}
+
+/// moves all entries of the box into the hash table
+template<class V>
+void LatticeMap<V>::to_hash()
+{
+    m_dense = false;
+    const size_t n = m_size;
+    reserve(n);
+    m_size = n;
+
+    const int d = lo.d();
+    Step<int> q(d);
+    for(size_t idx=0; idx<cells.size(); ++idx)
+    {
+        if(cells[idx].stamp != m_stamp)
+            continue;
+        size_t rest = idx;
+        for(int i=0; i<d; ++i)
+        {
+            q[i] = lo[i] + rest % extent[i];
+            rest /= extent[i];
+        }
+        Slot &s = slots[find_slot(q)];
+        s.key = q;
+        s.value = cells[idx].value;
+        s.stamp = m_stamp;
+    }
+
+    std::vector<Cell>().swap(cells);
+}
+
+/// pointer to the value of p or nullptr
+template<class V>
+V* LatticeMap<V>::find(const Step<int> &p)
+{
+    if(m_dense)
+    {
+        const long idx = cell_index(p);
+        return idx >= 0 && cells[idx].stamp == m_stamp ? &cells[idx].value : nullptr;
+    }
+
+    Slot &s = slots[find_slot(p)];
+    return s.stamp == m_stamp ? &s.value : nullptr;
+}
+
+template<class V>
+const V* LatticeMap<V>::find(const Step<int> &p) const
+{
+    if(m_dense)
+    {
+        const long idx = cell_index(p);
+        return idx >= 0 && cells[idx].stamp == m_stamp ? &cells[idx].value : nullptr;
+    }
+
+    const Slot &s = slots[find_slot(p)];
+    return s.stamp == m_stamp ? &s.value : nullptr;
+}
+
+/// value of p, which is default constructed if p is not in the map
+template<class V>
+V& LatticeMap<V>::operator[](const Step<int> &p)
+{
+    if(m_dense)
+    {
+        long idx = cell_index(p);
+        if(idx < 0)
+        {
+            grow_box(p);
+            if(!m_dense)
+                return operator[](p);
+            idx = cell_index(p);
+        }
+        Cell &c = cells[idx];
+        if(c.stamp != m_stamp)
+        {
+            c.value = V();
+            c.stamp = m_stamp;
+            ++m_size;
+        }
+        return c.value;
+    }
+
+    size_t i = find_slot(p);
+    if(slots[i].stamp != m_stamp)
+    {
+        if(2*(m_size+1) > slots.size())
+        {
+            grow();
+            i = find_slot(p);
+        }
+        slots[i].key = p;
+        slots[i].value = V();
+        slots[i].stamp = m_stamp;
+        ++m_size;
+    }
+    return slots[i].value;
+}
+
+/// inserts p, if it is not already in the map, returns whether it was inserted
+template<class V>
+bool LatticeMap<V>::insert(const Step<int> &p, const V &value)
+{
+    if(m_dense)
+    {
+        long idx = cell_index(p);
+        if(idx < 0)
+        {
+            grow_box(p);
+            if(!m_dense)
+                return insert(p, value);
+            idx = cell_index(p);
+        }
+        Cell &c = cells[idx];
+        if(c.stamp == m_stamp)
+            return false;
+        c.value = value;
+        c.stamp = m_stamp;
+        ++m_size;
+        return true;
+    }
+
+    size_t i = find_slot(p);
+    if(slots[i].stamp == m_stamp)
+        return false;
+
+    if(2*(m_size+1) > slots.size())
+    {
+        grow();
+        i = find_slot(p);
+    }
+    slots[i].key = p;
+    slots[i].value = value;
+    slots[i].stamp = m_stamp;
+    ++m_size;
+    return true;
+}
+
+/** Removes p, returns whether it was in the map.
+ *
+ * In the hash table the following entries of the probe sequence are
+ * shifted back into the gap, such that lookups never need tombstones.
+ */
+template<class V>
+bool LatticeMap<V>::erase(const Step<int> &p)
+{
+    if(m_dense)
+    {
+        const long idx = cell_index(p);
+        if(idx < 0 || cells[idx].stamp != m_stamp)
+            return false;
+        cells[idx].stamp = 0;
+        --m_size;
+        return true;
+    }
+
+    size_t i = find_slot(p);
+    if(slots[i].stamp != m_stamp)
+        return false;
+
+    for(size_t j = (i + 1) & mask; slots[j].stamp == m_stamp; j = (j + 1) & mask)
+    {
+        // the entry at j may fill the gap at i, if its home slot is not
+        // cyclically in (i, j]
+        const size_t home = hash(slots[j].key) & mask;
+        const bool between = i < j ? (i < home && home <= j) : (i < home || home <= j);
+        if(!between)
+        {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i].stamp = 0;
+    --m_size;
+    return true;
+}
+
+#endif
@@ -8,14 +8,17 @@ Permutation::Permutation(int length_)
 {
     length = length_;
     permutation.resize(length);
-    for(int i=0; i<length; ++i)
-        permutation[i] = i;
+    inverse_permutation.resize(length);
+    sort();
 }
 
 void Permutation::sort()
 {
     for(int i=0; i<length; ++i)
+    {
         permutation[i] = i;
+        inverse_permutation[i] = i;
+    }
 }
 
 int Permutation::value(int index)
@@ -1,4 +1,3 @@
-#include <map>
 #include <vector>
 #include <iostream>
 
@@ -12,7 +11,7 @@ protected:
     int length;
 
     std::vector<int> permutation;
-    std::map<int, int> inverse_permutation;
+    std::vector<int> inverse_permutation;
 
 public:
     Permutation();
@@ -53,9 +52,6 @@ void Permutation::shuffle(Iter begin, Iter end)
         permutation[i] = tmp;
     }
 
-    inverse_permutation.clear();
     for(int i=0; i<length; ++i)
-    {
-        inverse_permutation.emplace(permutation[i], i);
-    }
+        inverse_permutation[permutation[i]] = i;
 }
@@ -1,38 +1,409 @@
 #include "RNG.hpp"
 
+#include <stdexcept>
+#include <iomanip>
+
 std::vector<double> rng(int n, int seed)
 {
     UniformRNG u(seed);
     return u.vector(n);
 }
 
+/// 53 random bits of two words, in [0, 1)
+static inline double toUniform(uint32_t a, uint32_t b)
+{
+    return (((uint64_t) (a >> 5) << 26) | (b >> 6)) * (1. / 9007199254740992.);
+}
+
+/// Box-Muller transform of one block of four words
+static inline void boxMuller(const uint32_t *w, double &z0, double &z1)
+{
+    const double r = std::sqrt(-2. * std::log(1. - toUniform(w[0], w[1])));
+    const double phi = 2. * M_PI * toUniform(w[2], w[3]);
+    z0 = r * std::cos(phi);
+    z1 = r * std::sin(phi);
+}
+
+Philox4x32::Philox4x32(uint64_t seed, uint32_t replica, uint32_t walker)
+    : pos(0)
+{
+    key[0] = seed;
+    key[1] = seed >> 32;
+    stream[0] = replica;
+    stream[1] = walker;
+}
+
+/// The keyed bijection of Philox4x32 with 10 rounds.
+void Philox4x32::bijection(const uint32_t ctr[4], const uint32_t key_in[2], uint32_t out[4])
+{
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key_in[0], k1 = key_in[1];
+    for(int r=0; r<10; ++r)
+    {
+        const uint64_t p0 = (uint64_t) 0xD2511F53 * c0;
+        const uint64_t p1 = (uint64_t) 0xCD9E8D57 * c2;
+        c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+        c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t) p1;
+        c3 = (uint32_t) p0;
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+/// The counter is the index of the block and the stream ids.
+void Philox4x32::generateBlock()
+{
+    const uint64_t b = pos / 4;
+    const uint32_t ctr[4] = {(uint32_t) b, (uint32_t) (b >> 32), stream[0], stream[1]};
+    bijection(ctr, key, block);
+}
+
+/// Skips z numbers in O(1).
+void Philox4x32::discard(unsigned long long z)
+{
+    pos += z;
+    if(pos % 4 != 0)
+        generateBlock();
+}
+
+/** Writes the next n words to out.
+ *
+ * Same as n calls of operator(), but whole blocks are independent of
+ * each other and generated in one loop, which the compiler can
+ * vectorize.
+ */
+void Philox4x32::fill(uint32_t *out, size_t n)
+{
+    size_t i = 0;
+    // finish the current block
+    for(; i<n && pos % 4 != 0; ++i)
+        out[i] = (*this)();
+
+    const uint64_t b0 = pos / 4;
+    const size_t blocks = (n - i) / 4;
+    for(size_t j=0; j<blocks; ++j)
+    {
+        const uint64_t b = b0 + j;
+        const uint32_t ctr[4] = {(uint32_t) b, (uint32_t) (b >> 32), stream[0], stream[1]};
+        bijection(ctr, key, out + i + 4*j);
+    }
+    i += 4*blocks;
+    pos += 4*blocks;
+
+    for(; i<n; ++i)
+        out[i] = (*this)();
+}
+
+std::ostream& operator<<(std::ostream& os, const Philox4x32 &p)
+{
+    os << p.seed() << " " << p.stream[0] << " " << p.stream[1] << " " << p.pos;
+    return os;
+}
+
+std::istream& operator>>(std::istream& is, Philox4x32 &p)
+{
+    uint64_t seed, pos;
+    uint32_t replica, walker;
+    if(is >> seed >> replica >> walker >> pos)
+    {
+        p = Philox4x32(seed, replica, walker);
+        p.discard(pos);
+    }
+    return is;
+}
+
+OnDemandRN::OnDemandRN(uint64_t seed, uint32_t stream, int n, int width, bool gaussian)
+    : stream(stream),
+      m_width(width),
+      m_gaussian(gaussian),
+      draws(0),
+      base(0),
+      ids(n, 0),
+      undo_index(-1),
+      undo_offset(0)
+{
+    key[0] = seed;
+    key[1] = seed >> 32;
+}
+
+/// Number of draws since the last regenerate() which set entry i.
+uint64_t OnDemandRN::offset(int i) const
+{
+    uint64_t o = ids[i];
+    if(!high.empty())
+    {
+        const auto it = high.find(i);
+        if(it != high.end())
+            o |= (uint64_t) it->second << 32;
+    }
+    return o;
+}
+
+void OnDemandRN::setOffset(int i, uint64_t o)
+{
+    ids[i] = o;
+    if(o >> 32)
+        high[i] = o >> 32;
+    else if(!high.empty())
+        high.erase(i);
+}
+
+/** Numbers 2*block and 2*block+1 of entry i.
+ *
+ * Both are from one evaluation of the bijection, whose counter is the
+ * block, the draw and the stream.
+ */
+void OnDemandRN::pair(int i, int block, double &a, double &b) const
+{
+    const uint64_t draw = base + offset(i);
+    const uint32_t ctr[4] = {(uint32_t) (i * ((m_width+1) / 2) + block), (uint32_t) draw, (uint32_t) (draw >> 32), stream};
+    uint32_t out[4];
+    Philox4x32::bijection(ctr, key, out);
+    if(m_gaussian)
+    {
+        boxMuller(out, a, b);
+    }
+    else
+    {
+        a = toUniform(out[0], out[1]);
+        b = toUniform(out[2], out[3]);
+    }
+}
+
+/// Number k of entry i with its current draw, uniform in [0, 1) or gaussian.
+double OnDemandRN::operator()(int i, int k) const
+{
+    double a, b;
+    pair(i, k / 2, a, b);
+    return k % 2 ? b : a;
+}
+
+/// Writes the width() numbers of entry i to out.
+void OnDemandRN::fill(int i, double *out) const
+{
+    for(int k=0; k<m_width; k+=2)
+    {
+        double a, b;
+        pair(i, k / 2, a, b);
+        out[k] = a;
+        if(k+1 < m_width)
+            out[k+1] = b;
+    }
+}
+
+/// Replace entry i by a new, independent random number.
+void OnDemandRN::renew(int i)
+{
+    undo_index = i;
+    undo_offset = offset(i);
+
+    ++draws;
+    setOffset(i, draws - base);
+}
+
+/** Undo the last renew(i).
+ *
+ * Only the last renew() can be undone. The draw is not used again,
+ * i.e., the next renew(i) yields a new random number.
+ */
+void OnDemandRN::restore(int i)
+{
+    if(i != undo_index)
+        throw std::invalid_argument("only the last renew() can be restored");
+
+    setOffset(i, undo_offset);
+    undo_index = -1;
+}
+
+/// Replace all entries by new, independent random numbers.
+void OnDemandRN::regenerate()
+{
+    ++draws;
+    base = draws;
+    std::fill(ids.begin(), ids.end(), 0);
+    high.clear();
+    undo_index = -1;
+}
+
+// replicas and substreams are copied around, they need to stay small
+static_assert(sizeof(UniformRNG) <= sizeof(Philox4x32) + 4*sizeof(uint64_t),
+              "the Philox mode of UniformRNG should be a few words");
+
+const uint32_t UniformRNG::mcStream;
+const uint32_t UniformRNG::realizationStream;
+
+UniformRNG::UniformRNG(const UniformRNG &other)
+    : mt(other.mt ? new std::mt19937(*other.mt) : nullptr),
+      philox(other.philox),
+      m_seed(other.m_seed),
+      m_spare(other.m_spare),
+      m_has_spare(other.m_has_spare)
+{
+}
+
+UniformRNG& UniformRNG::operator=(const UniformRNG &other)
+{
+    if(this != &other)
+    {
+        if(!other.mt)
+            mt.reset();
+        else if(mt)
+            *mt = *other.mt;
+        else
+            mt.reset(new std::mt19937(*other.mt));
+        philox = other.philox;
+        m_seed = other.m_seed;
+        m_spare = other.m_spare;
+        m_has_spare = other.m_has_spare;
+    }
+    return *this;
+}
+
 void UniformRNG::reseed(int seed)
 {
-    rng.seed(seed);
+    mt.reset(new std::mt19937(seed));
+    m_seed = seed;
+    m_has_spare = false;
+}
+
+/// Skips z numbers of the underlying engine, O(1) for counter based streams.
+void UniformRNG::discard(unsigned long long z)
+{
+    if(mt)
+        mt->discard(z);
+    else
+        philox.discard(z);
+    m_has_spare = false;
+}
+
+/// The next n words of the underlying engine.
+void UniformRNG::words(uint32_t *out, size_t n)
+{
+    if(mt)
+        for(size_t i=0; i<n; ++i)
+            out[i] = (*mt)();
+    else
+        philox.fill(out, n);
+}
+
+/** An independent stream for a walker, e.g., of a MultipleWalker.
+ *
+ * It does not consume random numbers of this generator. For a Philox
+ * stream it has the same seed and replica. For the Mersenne Twister it
+ * is a Philox stream of replica 0, whose seed are the next 64 bits of a
+ * copy of the twister, such that it depends on the position of the
+ * twister and not only on its seed.
+ */
+UniformRNG UniformRNG::substream(uint32_t walker) const
+{
+    if(mt)
+    {
+        std::mt19937 copy(*mt);
+        const uint64_t seed = ((uint64_t) copy() << 32) | copy();
+        return UniformRNG(seed, 0, walker);
+    }
+    return UniformRNG(m_seed, philox.replica(), walker);
+}
+
+/// n entries of width random numbers calculated on demand, keyed by the next 64 bits of this generator.
+OnDemandRN UniformRNG::onDemand(int n, int width, bool gaussian)
+{
+    uint64_t seed;
+    if(mt)
+        seed = ((uint64_t) (*mt)() << 32) | (*mt)();
+    else
+        seed = ((uint64_t) philox() << 32) | philox();
+    return OnDemandRN(seed, 0, n, width, gaussian);
 }
 
 std::vector<double> UniformRNG::vector(int n)
 {
     std::vector<double> v(n);
-    for(auto &i : v)
-        i = uniform();
+    fill(v);
 
     return v;
 }
 
+/// Overwrites v with uniform random numbers, same as calling uniform() for every entry.
+void UniformRNG::fill(std::vector<double> &v)
+{
+    if(mt)
+    {
+        for(auto &i : v)
+            i = uniform();
+        return;
+    }
+
+    uint32_t w[512];
+    for(size_t i=0; i<v.size(); i+=256)
+    {
+        const size_t m = std::min((size_t) 256, v.size() - i);
+        philox.fill(w, 2*m);
+        for(size_t j=0; j<m; ++j)
+            v[i+j] = toUniform(w[2*j], w[2*j+1]);
+    }
+}
+
+/** Overwrites v with gaussian random numbers.
+ *
+ * Same as calling gaussian() for every entry, but the Box-Muller pairs
+ * are transformed in blocks.
+ */
+void UniformRNG::fill_gaussian(std::vector<double> &v, const double mu, const double sigma)
+{
+    size_t start = 0;
+    if(m_has_spare && !v.empty())
+    {
+        v[start++] = mu + sigma * m_spare;
+        m_has_spare = false;
+    }
+
+    uint32_t w[512];
+    const size_t pairs = (v.size() - start) / 2;
+    for(size_t i=0; i<pairs; i+=128)
+    {
+        const size_t m = std::min((size_t) 128, pairs - i);
+        words(w, 4*m);
+        for(size_t j=0; j<m; ++j)
+        {
+            double z0, z1;
+            boxMuller(w + 4*j, z0, z1);
+            v[start + 2*(i+j)] = mu + sigma * z0;
+            v[start + 2*(i+j)+1] = mu + sigma * z1;
+        }
+    }
+    if((v.size() - start) % 2)
+        v.back() = gaussian(mu, sigma);
+}
+
 std::vector<double> UniformRNG::vector_gaussian(int n, const double mu, const double sigma)
 {
     std::vector<double> v(n);
-    for(auto &i : v)
-        i = gaussian(mu, sigma);
+    fill_gaussian(v, mu, sigma);
 
     return v;
 }
 
+/** Serializes the state.
+ *
+ * The Mersenne Twister is written as by the standard library, a
+ * counter based stream as "philox4x32 seed replica walker position".
+ * A kept second gaussian value is appended.
+ */
 std::string UniformRNG::serialize_rng()
 {
     std::stringstream ss;
-    ss << rng;
+    if(mt)
+        ss << *mt;
+    else
+        ss << "philox4x32 " << philox;
+    if(m_has_spare)
+        ss << " " << std::setprecision(17) << m_spare;
     return std::string(ss.str());
 }
 
@@ -40,19 +411,49 @@ void UniformRNG::deserialize_rng(std::string &s)
 {
     std::stringstream ss;
     ss << s;
-    ss >> rng;
+    if(s.compare(0, 10, "philox4x32") == 0)
+    {
+        std::string tag;
+        mt.reset();
+        philox = Philox4x32();
+        ss >> tag >> philox;
+        m_seed = philox.seed();
+    }
+    else
+    {
+        if(!mt)
+            mt.reset(new std::mt19937());
+        ss >> *mt;
+    }
+    m_has_spare = static_cast<bool>(ss >> m_spare);
 }
 
 /// Generates uniformly distributed random numbers
 double UniformRNG::uniform()
 {
-    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    if(mt)
+        return std::uniform_real_distribution<double>(0.0, 1.0)(*mt);
+
+    const uint32_t a = philox();
+    const uint32_t b = philox();
+    return toUniform(a, b);
 }
 
-/// Generates normal distributed random numbers
+/// Generates normal distributed random numbers, two per Box-Muller transform
 double UniformRNG::gaussian(const double mu, const double sigma)
 {
-    return std::normal_distribution<double>(mu, sigma)(rng);
+    if(m_has_spare)
+    {
+        m_has_spare = false;
+        return mu + sigma * m_spare;
+    }
+
+    uint32_t w[4];
+    double z0;
+    words(w, 4);
+    boxMuller(w, z0, m_spare);
+    m_has_spare = true;
+    return mu + sigma * z0;
 }
 
 /** Generates a Levy distributed random number
@@ -110,11 +511,3 @@ double UniformRNG::cauchy(const double a)
 
     return a * tan(M_PI * u);
 }
-
-/** Returns the engine.
- * can be useful for stl algorithms, like std::shuffle
- */
-std::mt19937& UniformRNG::engine()
-{
-    return rng;
-}
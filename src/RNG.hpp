@@ -2,40 +2,193 @@
 #define RNG_H
 
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include <random>
+#include <memory>
+#include <unordered_map>
 #include <algorithm>
 #include <functional>
 #include <sstream>
 
 std::vector<double> rng(int n, int seed=0);
 
+/** Counter based random number generator Philox4x32-10.
+ *
+ * Salmon et al., "Parallel random numbers: as easy as 1, 2, 3" (2011).
+ * The 64 bit key is the seed, the 128 bit counter consists of the
+ * position in the stream and two stream ids. The state are a few
+ * words, every (seed, replica, walker) is an independent stream and
+ * skipping ahead is O(1).
+ */
+class Philox4x32
+{
+    public:
+        typedef uint32_t result_type;
+
+        Philox4x32(uint64_t seed=0, uint32_t replica=0, uint32_t walker=0);
+
+        result_type operator()()
+        {
+            if(pos % 4 == 0)
+                generateBlock();
+            return block[pos++ % 4];
+        }
+
+        void discard(unsigned long long z);
+        void fill(uint32_t *out, size_t n);
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return 0xffffffff; }
+
+        uint64_t seed() const { return ((uint64_t) key[1] << 32) | key[0]; }
+        uint32_t replica() const { return stream[0]; }
+        uint32_t walker() const { return stream[1]; }
+
+        static void bijection(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]);
+
+        friend std::ostream& operator<<(std::ostream& os, const Philox4x32 &p);
+        friend std::istream& operator>>(std::istream& is, Philox4x32 &p);
+
+    protected:
+        void generateBlock();
+
+        uint32_t key[2];
+        uint32_t stream[2];
+        uint64_t pos;       ///< number of 32 bit words drawn so far
+        uint32_t block[4];  ///< output of the counter pos/4
+};
+
+/** Random numbers which are calculated when needed instead of stored.
+ *
+ * Entry i is a pure function of the key, i and the number of the draw
+ * which set it, evaluated with the Philox4x32 bijection. Every renew()
+ * is a new draw of a 64 bit counter, which is never reset, such that a
+ * renewed entry is always a fresh random number, even after a
+ * restore(). regenerate() sets all entries with one new draw, i.e., to
+ * an independent set of entries.
+ *
+ * An entry consists of width() uniform or gaussian numbers, e.g., the
+ * d displacements of a step, two of them from one evaluation of the
+ * bijection.
+ *
+ * Only the low words of the draws since the last regenerate() are
+ * stored, four bytes per entry instead of eight for every double. The
+ * high words are kept in a sparse map, which is only filled for
+ * entries renewed after 2^32 draws within one realization.
+ */
+class OnDemandRN
+{
+    public:
+        OnDemandRN(uint64_t seed=0, uint32_t stream=0, int n=0, int width=1, bool gaussian=false);
+
+        double operator[](int i) const { return (*this)(i, 0); }
+        double operator()(int i, int k) const;
+        void fill(int i, double *out) const;
+
+        int size() const { return ids.size(); }
+        int width() const { return m_width; }
+
+        void renew(int i);
+        void restore(int i);
+        void regenerate();
+
+    protected:
+        uint64_t offset(int i) const;
+        void setOffset(int i, uint64_t o);
+        void pair(int i, int block, double &a, double &b) const;
+
+        uint32_t key[2];
+        uint32_t stream;
+        int m_width;
+        bool m_gaussian;
+        uint64_t draws;                             ///< number of draws so far
+        uint64_t base;                              ///< draws at the last regenerate()
+        std::vector<uint32_t> ids;                  ///< low word of the draw of every entry, relative to base
+        std::unordered_map<int, uint32_t> high;     ///< high words which are not zero
+
+        // state before the last renew()
+        int undo_index;
+        uint64_t undo_offset;
+};
+
 /** Wrapper for the random number generator.
  *
- * Uses a c++11 std Mersenne Twister generator, to yield random
- * numbers from different distributions.
+ * UniformRNG(seed) uses a c++11 std Mersenne Twister generator, which
+ * all reference data are generated with. Parallel code should use
+ * UniformRNG(seed, replica, walker), a counter based Philox4x32
+ * stream, which is independent of all other (seed, replica, walker).
+ * The thread is deliberately not part of the stream id, such that
+ * the results do not depend on the number of threads.
+ * The Monte Carlo stream of a replica is walker mcStream, its
+ * realization is walker realizationStream, such that they differ also
+ * for equal seeds, and the walkers of a MultipleWalker are
+ * substream(1), substream(2), ... of the realization.
+ * Both yield random numbers from different distributions.
+ *
+ * Gaussian numbers are generated with the Box-Muller transform of four
+ * words of either engine. The second value of a pair is kept for the
+ * next gaussian(), fill_gaussian() is the same as calling gaussian()
+ * for every entry, but transforms whole blocks at once.
  */
 class UniformRNG
 {
     protected:
-        std::mt19937 rng;
+        // the Mersenne Twister is 5 kB of state, keep it out of line,
+        // such that the Philox streams of the replicas are a few words
+        std::unique_ptr<std::mt19937> mt; ///< only for UniformRNG(seed)
+        Philox4x32 philox;
+        uint64_t m_seed;
+        double m_spare;     ///< second standard normal value of the last Box-Muller pair
+        bool m_has_spare;
+
+        void words(uint32_t *out, size_t n);
 
     public:
-        UniformRNG() {}
+        UniformRNG()
+            : mt(new std::mt19937()),
+              m_seed(std::mt19937::default_seed),
+              m_spare(0),
+              m_has_spare(false)
+        {}
 
         UniformRNG(int seed)
-            : rng(seed)
+            : mt(new std::mt19937(seed)),
+              m_seed(seed),
+              m_spare(0),
+              m_has_spare(false)
         {}
 
+        UniformRNG(uint64_t seed, uint32_t replica, uint32_t walker)
+            : philox(seed, replica, walker),
+              m_seed(seed),
+              m_spare(0),
+              m_has_spare(false)
+        {}
+
+        ///\name walker ids of the streams of a replica
+        static const uint32_t mcStream = 0;
+        static const uint32_t realizationStream = 0xffffffff;
+
+        UniformRNG(const UniformRNG &other);
+        UniformRNG& operator=(const UniformRNG &other);
+        UniformRNG(UniformRNG &&other) = default;
+        UniformRNG& operator=(UniformRNG &&other) = default;
+
         double operator()()
         {
             return uniform();
         }
 
         void reseed(int seed);
+        void discard(unsigned long long z);
+        UniformRNG substream(uint32_t walker) const;
+        OnDemandRN onDemand(int n, int width=1, bool gaussian=false);
 
         std::vector<double> vector(int n);
         std::vector<double> vector_gaussian(int n, const double mu=0., const double sigma=1.);
+        void fill(std::vector<double> &v);
+        void fill_gaussian(std::vector<double> &v, const double mu=0., const double sigma=1.);
 
         double uniform();
         double gaussian(const double mu=0., const double sigma=1.);
@@ -44,8 +197,6 @@ class UniformRNG
 
         std::string serialize_rng();
         void deserialize_rng(std::string &s);
-
-        std::mt19937& engine();
 };
 
 #endif
@@ -2,6 +2,7 @@
 #define STEP_H
 
 #include <cmath>
+#include <array>
 #include <list>
 #include <vector>
 #include <set>
@@ -22,6 +23,13 @@ namespace std {
 }
 
 /** Step class template, offers vector functions.
+ *
+ * Every Step stores its dimension and D_MAX coordinates, such that a
+ * vector of Steps is an array of structures of 20 (Step<int>) or 40
+ * (Step<double>) bytes for D_MAX = 4, and 12 or 24 bytes for D_MAX = 2.
+ * The dimension is not a template parameter. The hot loops over the
+ * points of SpecWalker switch once per call on d to loops with a
+ * constant number of coordinates.
  *
  * \tparam T datatype for the coordinates of the steps.
  *           int for steps on a lattice, double for real valued steps
@@ -21,24 +21,94 @@ void BM_convex_hull_algorithm(benchmark::State& state, hull_algorithm_t type, in
     while (state.KeepRunning())
         w->setHullAlgo(type);
 }
+template <class ...ExtraArgs>
+void BM_convex_hull_change(benchmark::State& state, hull_algorithm_t type, walk_type_t wtype=WT_RANDOM_WALK) {
+    Cmd o;
+
+    o.d = 2;
+    o.steps = state.range(0);
+    o.type = wtype;
+
+    o.chAlg = type;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+    UniformRNG rng(42);
+
+    while (state.KeepRunning())
+    {
+        w->change(rng);
+        w->undoChange();
+    }
+}
+template <class ...ExtraArgs>
+void BM_hull_diameter(benchmark::State& state, walk_type_t wtype=WT_RANDOM_WALK) {
+    Cmd o;
+
+    o.d = 2;
+    o.steps = state.range(0);
+    o.type = wtype;
+
+    o.chAlg = CH_ANDREWS_AKL;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(w->maxDiameter());
+        benchmark::DoNotOptimize(w->oblateness());
+    }
+}
+
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Andrews, CH_ANDREWS)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhull, CH_QHULL)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Jarvis, CH_JARVIS)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Graham, CH_GRAHAM)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Chan, CH_CHAN)->Arg(512)->Arg(2048);
 
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, AndrewsAkl, CH_ANDREWS_AKL)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhullAkl, CH_QHULL_AKL)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, JarvisAkl, CH_JARVIS_AKL)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, GrahamAkl, CH_GRAHAM_AKL)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, ChanAkl, CH_CHAN_AKL)->Arg(512)->Arg(2048);
 
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhull3d, CH_QHULL, 3)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhullAkl3d, CH_QHULL_AKL, 3)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Quickhull3d, CH_QUICKHULL_3D, 3)->Arg(512)->Arg(2048);
 
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Andrews_gauss, CH_ANDREWS, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhull_gauss, CH_QHULL, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Jarvis_gauss, CH_JARVIS, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Graham_gauss, CH_GRAHAM, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Chan_gauss, CH_CHAN, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, AndrewsAkl_gauss, CH_ANDREWS_AKL, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhullAkl_gauss, CH_QHULL_AKL, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, JarvisAkl_gauss, CH_JARVIS_AKL, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, GrahamAkl_gauss, CH_GRAHAM_AKL, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, ChanAkl_gauss, CH_CHAN_AKL, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhull3d_gauss, CH_QHULL, 3, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
 BENCHMARK_CAPTURE(BM_convex_hull_algorithm, qhullAkl3d_gauss, CH_QHULL_AKL, 3, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, Quickhull3d_gauss, CH_QUICKHULL_3D, 3, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, SegmentTree, CH_SEGMENT_TREE)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, SegmentTree_gauss, CH_SEGMENT_TREE, 2, WT_GAUSSIAN_RANDOM_WALK)->Arg(512)->Arg(2048);
+
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, AndrewsAkl_lattice, CH_ANDREWS_AKL, 2, WT_RANDOM_WALK)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, ColumnExtrema_lattice, CH_COLUMN_EXTREMA, 2, WT_RANDOM_WALK)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, AndrewsAkl_SAW, CH_ANDREWS_AKL, 2, WT_SELF_AVOIDING_RANDOM_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, ColumnExtrema_SAW, CH_COLUMN_EXTREMA, 2, WT_SELF_AVOIDING_RANDOM_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, AndrewsAkl_LERW, CH_ANDREWS_AKL, 2, WT_LOOP_ERASED_RANDOM_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, ColumnExtrema_LERW, CH_COLUMN_EXTREMA, 2, WT_LOOP_ERASED_RANDOM_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, AndrewsAkl_TSAW, CH_ANDREWS_AKL, 2, WT_TRUE_SELF_AVOIDING_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_convex_hull_algorithm, ColumnExtrema_TSAW, CH_COLUMN_EXTREMA, 2, WT_TRUE_SELF_AVOIDING_WALK)->Arg(2048)->Arg(16384);
+
+BENCHMARK_CAPTURE(BM_convex_hull_change, AndrewsAkl, CH_ANDREWS_AKL)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_convex_hull_change, SegmentTree, CH_SEGMENT_TREE)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_convex_hull_change, AndrewsAkl_gauss, CH_ANDREWS_AKL, WT_GAUSSIAN_RANDOM_WALK)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_convex_hull_change, SegmentTree_gauss, CH_SEGMENT_TREE, WT_GAUSSIAN_RANDOM_WALK)->Arg(2048)->Arg(131072);
+
+BENCHMARK_CAPTURE(BM_hull_diameter, lattice, WT_RANDOM_WALK)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_hull_diameter, gauss, WT_GAUSSIAN_RANDOM_WALK)->Arg(2048)->Arg(131072);
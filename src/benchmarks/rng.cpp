@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include "../RNG.hpp"
+
+static void BM_uniform_mt19937(benchmark::State& state) {
+    UniformRNG rng(42);
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(rng());
+}
+BENCHMARK(BM_uniform_mt19937);
+
+static void BM_uniform_philox(benchmark::State& state) {
+    UniformRNG rng(42, 0, 0);
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(rng());
+}
+BENCHMARK(BM_uniform_philox);
+
+static void BM_gaussian_mt19937(benchmark::State& state) {
+    UniformRNG rng(42);
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(rng.gaussian());
+}
+BENCHMARK(BM_gaussian_mt19937);
+
+static void BM_gaussian_philox(benchmark::State& state) {
+    UniformRNG rng(42, 0, 0);
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(rng.gaussian());
+}
+BENCHMARK(BM_gaussian_philox);
+
+static void BM_vector_gaussian_mt19937(benchmark::State& state) {
+    UniformRNG rng(42);
+    std::vector<double> v(state.range(0));
+    while (state.KeepRunning())
+    {
+        rng.fill_gaussian(v);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_vector_gaussian_mt19937)->Arg(1<<16);
+
+static void BM_vector_gaussian_philox(benchmark::State& state) {
+    UniformRNG rng(42, 0, 0);
+    std::vector<double> v(state.range(0));
+    while (state.KeepRunning())
+    {
+        rng.fill_gaussian(v);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_vector_gaussian_philox)->Arg(1<<16);
+
+static void BM_vector_uniform_philox(benchmark::State& state) {
+    UniformRNG rng(42, 0, 0);
+    std::vector<double> v(state.range(0));
+    while (state.KeepRunning())
+    {
+        rng.fill(v);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_vector_uniform_philox)->Arg(1<<16);
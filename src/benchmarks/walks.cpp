@@ -9,6 +9,7 @@
 #include "../walker/GaussWalker.hpp"
 #include "../walker/LevyWalker.hpp"
 #include "../walker/CorrelatedWalker.hpp"
+#include "../walker/ScentWalker.hpp"
 #include "../simulation/Simulation.hpp"
 #include "../simulation/SimpleSampling.hpp"
 #include "../simulation/Metropolis.hpp"
@@ -40,5 +41,164 @@ void BM_walk_construction(benchmark::State& state, walk_type_t type, int d=2) {
 }
 
 BENCHMARK_CAPTURE(BM_walk_construction, LRW, WT_RANDOM_WALK)->Arg(512)->Arg(2048);
-// BENCHMARK_CAPTURE(BM_walk_construction, SAW, WT_SELF_AVOIDING_RANDOM_WALK)->Arg(512)->Arg(2048);
-// BENCHMARK_CAPTURE(BM_walk_construction, LERW, WT_LOOP_ERASED_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_construction, SAW, WT_SELF_AVOIDING_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_construction, LERW, WT_LOOP_ERASED_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_construction, TSAW, WT_TRUE_SELF_AVOIDING_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_construction, Escape, WT_ESCAPE_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_construction, Escape3d, WT_ESCAPE_RANDOM_WALK, 3)->Arg(512)->Arg(2048);
+
+static void BM_scent_construction(benchmark::State& state, bool parallel) {
+    Cmd o;
+
+    o.d = 2;
+    o.steps = 1000;
+    o.type = WT_SCENT_RANDOM_WALK;
+    o.numWalker = state.range(0);
+    o.width = 100;
+    o.tas = 100;
+    o.agent_start = AS_RELAXED;
+
+    o.chAlg = CH_NOP;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+    dynamic_cast<ScentWalker&>(*w).minParallelWalkers = parallel ? 1 : std::numeric_limits<int>::max();
+
+    while (state.KeepRunning())
+        w->updateSteps();
+}
+
+BENCHMARK_CAPTURE(BM_scent_construction, serial, false)->Arg(10)->Arg(100);
+BENCHMARK_CAPTURE(BM_scent_construction, parallel, true)->Arg(10)->Arg(100);
+
+template <class ...ExtraArgs>
+void BM_walk_points(benchmark::State& state, walk_type_t type, int d=2) {
+    Cmd o;
+
+    o.d = d;
+    o.steps = state.range(0);
+    o.type = type;
+
+    o.chAlg = CH_NOP;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+
+    while (state.KeepRunning())
+        w->updatePoints();
+}
+
+BENCHMARK_CAPTURE(BM_walk_points, LRW, WT_RANDOM_WALK)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_walk_points, LRW3d, WT_RANDOM_WALK, 3)->Arg(2048)->Arg(131072);
+BENCHMARK_CAPTURE(BM_walk_points, Gauss, WT_GAUSSIAN_RANDOM_WALK)->Arg(2048)->Arg(131072);
+
+template <class ...ExtraArgs>
+void BM_walk_change(benchmark::State& state, walk_type_t type, int d=2) {
+    Cmd o;
+
+    o.d = d;
+    o.steps = state.range(0);
+    o.type = type;
+    // changes need the random numbers of the walk, i.e., no amnesia
+    o.sampling_method = SM_METROPOLIS;
+    // only used by the resetting walks
+    o.resetrate = 0.1;
+
+    o.chAlg = CH_NOP;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+
+    UniformRNG rng(42);
+    while (state.KeepRunning())
+    {
+        w->change(rng, false);
+        w->undoChange();
+    }
+}
+
+BENCHMARK_CAPTURE(BM_walk_change, SAW, WT_SELF_AVOIDING_RANDOM_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_walk_change, SAW3d, WT_SELF_AVOIDING_RANDOM_WALK, 3)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_walk_change, LERW, WT_LOOP_ERASED_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_change, TSAW, WT_TRUE_SELF_AVOIDING_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_walk_change, Reset, WT_RESET_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_walk_change, Returning, WT_RETURNING_LATTICE_WALK)->Arg(2048)->Arg(16384);
+BENCHMARK_CAPTURE(BM_walk_change, Escape, WT_ESCAPE_RANDOM_WALK)->Arg(512)->Arg(2048);
+BENCHMARK_CAPTURE(BM_walk_change, Escape3d, WT_ESCAPE_RANDOM_WALK, 3)->Arg(512)->Arg(2048);
+
+static void BM_multi_change(benchmark::State& state) {
+    Cmd o;
+
+    o.d = 2;
+    o.steps = 1000;
+    o.type = WT_RANDOM_WALK;
+    o.numWalker = state.range(0);
+    o.sampling_method = SM_METROPOLIS;
+
+    o.chAlg = CH_ANDREWS;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+
+    UniformRNG rng(42);
+    while (state.KeepRunning())
+    {
+        w->change(rng);
+        w->undoChange();
+    }
+}
+
+BENCHMARK(BM_multi_change)->Arg(10)->Arg(100);
+
+static void BM_metropolis(benchmark::State& state) {
+    Cmd o;
+
+    o.d = 2;
+    o.steps = state.range(0);
+    o.type = WT_RANDOM_WALK;
+    o.sampling_method = SM_METROPOLIS;
+    o.wantedObservable = WO_VOLUME;
+    o.theta = -20;
+    o.iterations = 10;
+    o.t_eq = 0;
+    // long sweeps, such that the output after every sweep does not matter
+    o.sweep = 100 * o.steps;
+    o.data_path = "bench.tmp";
+
+    o.chAlg = CH_SEGMENT_TREE;
+
+    Metropolis m(o);
+    m.mute();
+
+    while (state.KeepRunning())
+        m.run();
+    state.SetItemsProcessed(state.iterations() * o.iterations * o.sweep);
+}
+
+BENCHMARK(BM_metropolis)->Arg(16)->Arg(64);
+
+static void BM_perm_tour(benchmark::State& state) {
+    Cmd o;
+
+    o.d = 2;
+    o.steps = state.range(0);
+    o.type = WT_SELF_AVOIDING_RANDOM_WALK;
+
+    o.chAlg = CH_NOP;
+
+    std::unique_ptr<Walker> w;
+    Simulation::prepare(w, o);
+    auto saw = static_cast<SelfAvoidingWalker*>(w.get());
+
+    UniformRNG rng(42, 0, 0);
+    SelfAvoidingWalker::PERMEstimate estimate;
+    int samples = 0;
+    while (state.KeepRunning())
+    {
+        saw->tourPERM(rng, [&](double){ ++samples; }, estimate);
+        estimate.add(saw->tourEstimate());
+    }
+    state.counters["samples"] = benchmark::Counter(samples, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_perm_tour)->Arg(512)->Arg(2048);
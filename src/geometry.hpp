@@ -1,7 +1,11 @@
 #ifndef GEOMETRY_H
 #define GEOMETRY_H
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
 
 #include <Qhull.h>
 #include <QhullVertex.h>
@@ -23,6 +27,13 @@ T cross2d_z(const Step<T>& O,
     return (A.x() - O.x()) * (B.y() - O.y()) - (A.y() - O.y()) * (B.x() - O.x());
 }
 
+/// Squared distance between O and A in the plane.
+template <class T>
+T distance2d_squared(const Step<T>& O, const Step<T>& A)
+{
+    return (A.x() - O.x()) * (A.x() - O.x()) + (A.y() - O.y()) * (A.y() - O.y());
+}
+
 template <class T>
 T cross2d_z(const std::array<T, 2>& O,
             const std::array<T, 2>& A,
@@ -31,6 +42,316 @@ T cross2d_z(const std::array<T, 2>& O,
     return (A[0] - O[0]) * (B[1] - O[1]) - (A[1] - O[1]) * (B[0] - O[0]);
 }
 
+/// Measures of a convex polygon obtained by rotatingCalipers().
+struct Calipers
+{
+    double diameter = 0;     ///< largest distance of two vertices
+    int diameterI = 0;       ///< index of the larger vertex of a pair at that distance
+    int diameterJ = 0;       ///< index of the smaller vertex of a pair at that distance
+    double width = 0;        ///< smallest distance of two parallel supporting lines
+    double minRectangle = 0; ///< area of the smallest enclosing rectangle
+};
+
+/** Rotating calipers over a convex polygon in the plane in O(h).
+ *
+ * The vertices need to be in order (of either orientation), a closing
+ * vertex equal to the first is ignored. Of multiple pairs at the
+ * diameter, the one with the smallest diameterI and then diameterJ is
+ * chosen, i.e., the first a loop over i and j < i would find.
+ */
+template <class T>
+Calipers rotatingCalipers(const std::vector<Step<T>> &p)
+{
+    Calipers c;
+    int h = p.size();
+    if(h > 1 && p.front() == p.back())
+        --h;
+
+    double best = 0;
+    auto candidate = [&](int a, int b)
+    {
+        const int i = std::max(a, b);
+        const int j = std::min(a, b);
+        const double dd = distance2d_squared(p[i], p[j]);
+        if(dd > best || (dd == best && (i < c.diameterI || (i == c.diameterI && j < c.diameterJ))))
+        {
+            best = dd;
+            c.diameterI = i;
+            c.diameterJ = j;
+        }
+    };
+    // twice the area of the triangle of edge i and vertex k
+    auto height = [&](int i, int k) -> double
+    {
+        return std::abs(cross2d_z(p[i], p[(i+1) % h], p[k]));
+    };
+    // projection of vertex k on edge i, times the length of the edge
+    auto projection = [&](int i, int k) -> double
+    {
+        const Step<T> &a = p[i];
+        const Step<T> &b = p[(i+1) % h];
+        return (b.x() - a.x()) * (p[k].x() - a.x()) + (b.y() - a.y()) * (p[k].y() - a.y());
+    };
+
+    if(h < 2)
+        return c;
+
+    // starting points of the calipers for the first edge
+    int j = 0, hi = 0, lo = 0;
+    for(int k=1; k<h; ++k)
+    {
+        if(height(0, k) > height(0, j))
+            j = k;
+        if(projection(0, k) > projection(0, hi))
+            hi = k;
+        if(projection(0, k) < projection(0, lo))
+            lo = k;
+    }
+
+    // all points on a line, there are no antipodal edges
+    if(height(0, j) == 0)
+    {
+        for(int a=0; a<h; ++a)
+            for(int b=0; b<a; ++b)
+                candidate(a, b);
+        c.diameter = std::sqrt(best);
+        return c;
+    }
+
+    bool first = true;
+    for(int i=0; i<h; ++i)
+    {
+        const int ni = (i+1) % h;
+        while(height(i, (j+1) % h) > height(i, j))
+            j = (j+1) % h;
+        while(projection(i, (hi+1) % h) > projection(i, hi))
+            hi = (hi+1) % h;
+        while(projection(i, (lo+1) % h) < projection(i, lo))
+            lo = (lo+1) % h;
+
+        candidate(i, j);
+        candidate(ni, j);
+        // edge parallel to edge i
+        if(height(i, (j+1) % h) == height(i, j))
+        {
+            candidate(i, (j+1) % h);
+            candidate(ni, (j+1) % h);
+        }
+
+        const double len2 = distance2d_squared(p[i], p[ni]);
+        if(len2 == 0)
+            continue;
+        const double w = height(i, j) / std::sqrt(len2);
+        const double rect = height(i, j) * (projection(i, hi) - projection(i, lo)) / len2;
+        if(first || w < c.width)
+            c.width = w;
+        if(first || rect < c.minRectangle)
+            c.minRectangle = rect;
+        first = false;
+    }
+
+    c.diameter = std::sqrt(best);
+    return c;
+}
+
+/** Type wide enough to evaluate the products of coordinate differences
+ * occuring in the 3D predicates exactly.
+ *
+ * For lattice walks this is a 64 bit integer, which is exact as long
+ * as the extent of the walk stays below about 10^6.
+ */
+template <class T>
+struct exact_t { typedef T type; };
+
+template <>
+struct exact_t<int> { typedef long long type; };
+
+/** Orientation of point D relative to the plane through A, B, C.
+ *
+ * Returns six times the signed volume of the tetrahedron ABCD, i.e.
+ * a positive value, if D lies on the side the normal (B-A)x(C-A)
+ * points to, negative on the other side and zero if all four points
+ * are coplanar. Exact for Step<int>.
+ */
+template <class T>
+typename exact_t<T>::type orientation3d(const Step<T>& A,
+                                        const Step<T>& B,
+                                        const Step<T>& C,
+                                        const Step<T>& D)
+{
+    typedef typename exact_t<T>::type E;
+    const E bx = B.x() - A.x(), by = B.y() - A.y(), bz = B.z() - A.z();
+    const E cx = C.x() - A.x(), cy = C.y() - A.y(), cz = C.z() - A.z();
+    const E dx = D.x() - A.x(), dy = D.y() - A.y(), dz = D.z() - A.z();
+
+    return bx * (cy * dz - cz * dy)
+         - by * (cx * dz - cz * dx)
+         + bz * (cx * dy - cy * dx);
+}
+
+/** Exact arithmetic on expansions, i.e., sums of non-overlapping doubles.
+ *
+ * Only used as fallback for orientation3d, if the result in floating
+ * point arithmetic is too close to zero to trust its sign.
+ * See J. R. Shewchuk, Adaptive Precision Floating-Point Arithmetic and
+ * Fast Robust Geometric Predicates (1997).
+ *
+ * The intermediate results are volatile, such that -ffast-math can not
+ * optimize the rounding errors away.
+ */
+namespace expansion
+{
+    /// x + y == a + b exactly
+    inline void twoSum(double a, double b, double &x, double &y)
+    {
+        volatile double s = a + b;
+        volatile double bv = s - a;
+        volatile double av = s - bv;
+        volatile double ar = a - av;
+        volatile double br = b - bv;
+        x = s;
+        y = ar + br;
+    }
+
+    /// x + y == a * b exactly
+    inline void twoProduct(double a, double b, double &x, double &y)
+    {
+        volatile double p = a * b;
+        x = p;
+        y = std::fma(a, b, -x);
+    }
+
+    /// h = e + b, with zero elimination
+    inline void grow(const std::vector<double> &e, double b, std::vector<double> &h)
+    {
+        h.clear();
+        double q = b;
+        for(double ei : e)
+        {
+            double sum, err;
+            twoSum(q, ei, sum, err);
+            q = sum;
+            if(err != 0)
+                h.push_back(err);
+        }
+        if(q != 0 || h.empty())
+            h.push_back(q);
+    }
+
+    /// h = e + f
+    inline void sum(const std::vector<double> &e, const std::vector<double> &f, std::vector<double> &h)
+    {
+        std::vector<double> tmp;
+        h = e;
+        for(double fi : f)
+        {
+            grow(h, fi, tmp);
+            h.swap(tmp);
+        }
+    }
+
+    /// h = e * b, with zero elimination
+    inline void scale(const std::vector<double> &e, double b, std::vector<double> &h)
+    {
+        h.clear();
+        double q, err;
+        twoProduct(e[0], b, q, err);
+        if(err != 0)
+            h.push_back(err);
+        for(size_t i=1; i<e.size(); ++i)
+        {
+            double p1, p0, s;
+            twoProduct(e[i], b, p1, p0);
+            twoSum(q, p0, s, err);
+            if(err != 0)
+                h.push_back(err);
+            twoSum(p1, s, q, err);
+            if(err != 0)
+                h.push_back(err);
+        }
+        if(q != 0 || h.empty())
+            h.push_back(q);
+    }
+
+    /// h = e * f
+    inline void product(const std::vector<double> &e, const std::vector<double> &f, std::vector<double> &h)
+    {
+        std::vector<double> part, tmp;
+        h.assign(1, 0.);
+        for(double fi : f)
+        {
+            scale(e, fi, part);
+            sum(h, part, tmp);
+            h.swap(tmp);
+        }
+    }
+
+    /// a - b as expansion
+    inline std::vector<double> difference(double a, double b)
+    {
+        double x, y;
+        twoSum(a, -b, x, y);
+        if(y == 0)
+            return {x};
+        return {y, x};
+    }
+}
+
+/** Orientation of point D relative to the plane through A, B, C.
+ *
+ * The sign is exact, for results close to zero it is determined with
+ * exact arithmetic. This is necessary for the native 3D hull, which
+ * breaks on inconsistent decisions.
+ */
+template <>
+inline double orientation3d(const Step<double>& A,
+                            const Step<double>& B,
+                            const Step<double>& C,
+                            const Step<double>& D)
+{
+    const double bx = B.x() - A.x(), by = B.y() - A.y(), bz = B.z() - A.z();
+    const double cx = C.x() - A.x(), cy = C.y() - A.y(), cz = C.z() - A.z();
+    const double dx = D.x() - A.x(), dy = D.y() - A.y(), dz = D.z() - A.z();
+
+    const double det = bx * (cy * dz - cz * dy)
+                     - by * (cx * dz - cz * dx)
+                     + bz * (cx * dy - cy * dx);
+
+    // error bound of the floating point evaluation (with some slack)
+    const double permanent = std::abs(bx) * (std::abs(cy * dz) + std::abs(cz * dy))
+                           + std::abs(by) * (std::abs(cx * dz) + std::abs(cz * dx))
+                           + std::abs(bz) * (std::abs(cx * dy) + std::abs(cy * dx));
+    if(std::abs(det) > 16 * std::numeric_limits<double>::epsilon() * permanent)
+        return det;
+
+    // a vertex of the triangle is the most common exactly coplanar point
+    if(D == A || D == B || D == C)
+        return 0;
+
+    using namespace expansion;
+    const std::vector<double> ex[3] = {difference(B.x(), A.x()), difference(B.y(), A.y()), difference(B.z(), A.z())};
+    const std::vector<double> ey[3] = {difference(C.x(), A.x()), difference(C.y(), A.y()), difference(C.z(), A.z())};
+    const std::vector<double> ez[3] = {difference(D.x(), A.x()), difference(D.y(), A.y()), difference(D.z(), A.z())};
+
+    // expand the determinant along the first vector
+    std::vector<double> result(1, 0.), p, q, minor, term, tmp;
+    for(int i=0; i<3; ++i)
+    {
+        const int j = (i+1) % 3, k = (i+2) % 3;
+        product(ey[j], ez[k], p);
+        product(ey[k], ez[j], q);
+        for(double &x : q)
+            x = -x;
+        sum(p, q, minor);
+        product(ex[i], minor, term);
+        sum(result, term, tmp);
+        result.swap(tmp);
+    }
+
+    // the largest component has the sign of the exact value
+    return result.back();
+}
+
 /** Test if point p is inside the triangel formed by p1, p2, p3.
  *
  * Sequence of the points matters, must be counterclockwise.
@@ -273,34 +594,4 @@ int orientation(Step<T> O, Step<T> A, Step<T> B)
 	return (val > 0)? -1: 1; // CW: -1 or CCW: 1
 }
 
-// cmp: https://github.com/ypranay/Convex-Hull/blob/master/ChansAlgorithmForConvexHull.cpp
-template <class T>
-Step<T> polygon_tangent(const Step<T> &p, const std::vector<Step<T>> &v)
-{
-    // search for the tangent through `p` of the polygon `poly`
-    // use a clever binary search
-    // all points q before the tangent t are ptq oriented ccw and after cw
-
-    int n = v.size();
-    int l = 0;
-    int r = n;
-    int l_before = orientation(p, v[0], v[n-1]);
-    int l_after = orientation(p, v[0], v[(l + 1) % n]);
-    while (l < r){
-        int c = (l + r)/2;
-        int c_before = orientation(p, v[c], v[(c - 1) % n]);
-        int c_after = orientation(p, v[c], v[(c + 1) % n]);
-        int c_side = orientation(p, v[l], v[c]);
-        if (c_before >= 0 && c_after >= 0)
-            return v[c];
-        else if (((c_side > 0) && (l_after < 0 || l_before == l_after)) || (c_side < 0 && c_before < 0))
-            r = c;
-        else
-            l = c + 1 ;
-        l_before = -c_after;
-        l_after = orientation(p, v[l%n], v[(l + 1) % n]);
-    }
-    return v[l%n];
-}
-
 #endif
@@ -6,6 +6,37 @@ FastWLEntropic::FastWLEntropic(const Cmd &o)
 {
 }
 
+/** n trials with the acceptance given by g.
+ *
+ * After every trial, lnf is added to g (unless it is 0) and the
+ * current S is added to H (unless it is nullptr).
+ */
+template <class W, class Obs>
+void FastWLEntropic::trials(W &w, const Obs &S, Histogram &g, Histogram *H, const double lnf, const double lb, const double ub, UniformRNG &rngMC, const int n)
+{
+    double s = S(w);
+    for(int j=0; j<n; ++j)
+    {
+        w.change(rngMC);
+        ++tries;
+
+        const double newS = S(w);
+        const double p_acc = std::exp(g[s] - g[newS]);
+        if(newS < lb || newS > ub || p_acc < rngMC())
+        {
+            w.undoChange();
+            ++fails;
+        }
+        else
+            s = newS;
+
+        if(lnf != 0)
+            g.add(s, lnf);
+        if(H)
+            H->add(s);
+    }
+}
+
 /** Implementation of the "Fast" 1/t Wang Landau algorithm extended by Entropic Sampling.
  *
  * Larger values of the final refinement parameter are ok, since
@@ -26,13 +57,11 @@ void FastWLEntropic::run()
     #pragma omp parallel for schedule(dynamic)
     for(int n=0; n<o.iterations; ++n)
     {
-        // rngs should be local to the threads, with different seeds
-        // FIXME: think about a better seed
-        UniformRNG rngMC((o.seedMC+n) * (n+1));
-        o.seedRealization = ((long long)(o.seedRealization + n) * (n+1)) % 1800000121;
+        // rngs should be local to the threads, every iteration has its own stream
+        UniformRNG rngMC(o.seedMC, n, UniformRNG::mcStream);
 
         std::unique_ptr<Walker> w;
-        prepare(w, o);
+        prepare(w, o, UniformRNG(o.seedRealization, n, UniformRNG::realizationStream));
 
         for(int i=0; i<num_ranges; ++i)
         {
@@ -60,30 +89,8 @@ void FastWLEntropic::run()
                 {
                     for(int k=0; k < initial_num_iterations; ++k)
                     {
-                        for(int j=0; j < o.steps; ++j)
-                        {
-                            double oldS = S(w);
-                            w->change(rngMC);
-                            ++tries;
-
-                            double p_acc = std::exp(g[oldS] - g[S(w)]);
-                            if(S(w) < lb || S(w) > ub || p_acc < rngMC())
-                            {
-                                w->undoChange();
-                                ++fails;
-                            }
-
-                            g.add(S(w), lnf);
-                            H.add(S(w));
-
-                            // if(tries % 100 == 0)
-                            // {
-                            //     std::ofstream osg(std::to_string(tries)+".g");
-                            //     std::ofstream osH(std::to_string(tries)+".H");
-                            //     osg << g.ascii_table();
-                            //     osH << H.ascii_table();
-                            // }
-                        }
+                        Trials sweep(*this, g, &H, lnf, lb, ub, rngMC, o.steps);
+                        dispatch(*w, o, sweep);
                         ++t;
                     }
 
@@ -124,28 +131,8 @@ void FastWLEntropic::run()
                     status /= 2;
                 }
 
-                for(int j=0; j < o.steps; ++j)
-                {
-                    double oldS = S(w);
-                    w->change(rngMC);
-                    ++tries;
-
-                    double p_acc = std::exp(g[oldS] - g[S(w)]);
-                    if(S(w) < lb || S(w) > ub || p_acc < rngMC())
-                    {
-                        w->undoChange();
-                        ++fails;
-                    }
-
-                    g.add(S(w), lnf);
-                    // if(tries % 100 == 0)
-                    // {
-                    //     std::ofstream osg(std::to_string(tries)+".g");
-                    //     std::ofstream osH(std::to_string(tries)+".H");
-                    //     osg << g.ascii_table();
-                    //     osH << H.ascii_table();
-                    // }
-                }
+                Trials sweep(*this, g, nullptr, lnf, lb, ub, rngMC, o.steps);
+                dispatch(*w, o, sweep);
                 ++t;
             }
 
@@ -161,21 +148,9 @@ void FastWLEntropic::run()
                           << " until t=" << (t+t_limit);
             for(int j=0; j<t_limit; ++j)
             {
-                for(int k=0; k < o.steps; ++k)
-                {
-                    double oldS = S(w);
-                    w->change(rngMC);
-                    ++tries;
-
-                    double p_acc = std::exp(g[oldS] - g[S(w)]);
-                    if(S(w) < lb || S(w) > ub || p_acc < rngMC())
-                    {
-                        w->undoChange();
-                        ++fails;
-                    }
-
-                    H.add(S(w));
-                }
+                // g is not changed anymore
+                Trials sweep(*this, g, &H, 0, lb, ub, rngMC, o.steps);
+                dispatch(*w, o, sweep);
 
                 #pragma omp critical
                 {
@@ -19,6 +19,28 @@ class FastWLEntropic : public WangLandau
 
     protected:
         std::ofstream oss2;
+
+        template <class W, class Obs>
+        void trials(W &w, const Obs &S, Histogram &g, Histogram *H, double lnf, double lb, double ub, UniformRNG &rngMC, int n);
+
+        /// trials() as functor for dispatch()
+        struct Trials
+        {
+            Trials(FastWLEntropic &sim, Histogram &g, Histogram *H, double lnf, double lb, double ub, UniformRNG &rngMC, int n)
+                : sim(sim), g(g), H(H), lnf(lnf), lb(lb), ub(ub), rngMC(rngMC), n(n) {}
+
+            template <class W, class Obs>
+            void operator()(W &w, const Obs &S) { sim.trials(w, S, g, H, lnf, lb, ub, rngMC, n); }
+
+            FastWLEntropic &sim;
+            Histogram &g;
+            Histogram *H;
+            double lnf;
+            double lb;
+            double ub;
+            UniformRNG &rngMC;
+            int n;
+        };
 };
 
 #endif
@@ -197,24 +197,15 @@ void Metropolis::run()
             o.t_eq = o.t_eqMax;
         }
 
+        MetropolisSweep sweep(*this, o.theta, rngMC, o.sweep);
         for(int i=o.t_eq; i<o.iterations+2*o.t_eq; ++i)
         {
             // one sweep, i.e., o.sweep many change tries (default o.steps)
-            for(int j=0; j<o.sweep; ++j)
-            {
-                // change one random number to another random number
-                double oldS = S(w);
-                w->change(rngMC);
-                ++tries;
-
-                // Metropolis rejection
-                double p_acc = std::exp((oldS - S(w))/o.theta);
-                if(p_acc < rngMC())
-                {
-                    ++fails;
-                    w->undoChange();
-                }
-            }
+            // change one random number to another random number
+            // with Metropolis rejection
+            dispatch(*w, o, sweep);
+            tries += o.sweep;
+            fails += sweep.fails;
 
             // save measurements to file
             if(i >= 2*o.t_eq)
@@ -54,10 +54,8 @@ void MetropolisParallelTempering::run()
     std::vector<UniformRNG> rngs;
     for(int n=0; n<numTemperatures; ++n)
     {
-        // give every temperature a different rng for thread safeness
-        // ensure that seeds do not overflow
-        const int seedMC = ((uint64_t)(o.seedMC+n) * (n+1)) % 1800000113;
-        rngs.emplace_back(seedMC);
+        // give every temperature an independent stream for thread safeness
+        rngs.emplace_back(o.seedMC, n, UniformRNG::mcStream);
     }
 
     #pragma omp parallel
@@ -66,9 +64,7 @@ void MetropolisParallelTempering::run()
         #pragma omp for schedule(static, 1)
         for(int n=0; n<numTemperatures; ++n)
         {
-            Cmd tmp(o);
-            tmp.seedRealization = ((uint64_t)(tmp.seedRealization + n) * (n+1)) % 1800000121;
-            prepare(allWalkers[n], tmp);
+            prepare(allWalkers[n], o, UniformRNG(o.seedRealization, n, UniformRNG::realizationStream));
         }
 
         for(int i=0; i<o.iterations+2*o.t_eq; )
@@ -185,17 +181,10 @@ void MetropolisParallelTempering::run()
 void MetropolisParallelTempering::sweep(std::unique_ptr<Walker> &w, double theta, UniformRNG &rngMC)
 {
     // one sweep, i.e., o.sweep many change tries (default o.steps)
-    for(int j=0; j<o.sweep; ++j)
-    {
-        // change one random number to another random number
-        const double oldS = S(w);
-        w->change(rngMC);
-
-        // Metropolis rejection
-        const double p_acc = std::exp((oldS - S(w))/theta);
-        if(p_acc < rngMC())
-            w->undoChange();
-    }
+    // change one random number to another random number
+    // with Metropolis rejection
+    MetropolisSweep sweep(*this, theta, rngMC, o.sweep);
+    dispatch(*w, o, sweep);
 }
 
 std::vector<double> MetropolisParallelTempering::proposeBetterTemperatures()
@@ -64,15 +64,12 @@ void MetropolisParallelTemperingMPI::run()
     double theta;
     char *filename = new char[max_filename_len];
 
-    // give every Thread a different seed
-    // ensure that they do not overflow
+    // give every process an independent stream
     // rank is deterministic
-    const int seedMC = ((uint64_t)(o.seedMC+rank) * (rank+1)) % 1800000113;
-    UniformRNG rngMC(seedMC);
+    UniformRNG rngMC(o.seedMC, rank, UniformRNG::mcStream);
     std::unique_ptr<Walker> walker;
 
-    o.seedRealization = ((uint64_t)(o.seedRealization + rank) * (rank+1)) % 1800000121;
-    prepare(walker, o);
+    prepare(walker, o, UniformRNG(o.seedRealization, rank, UniformRNG::realizationStream));
 
     for(int i=0; i<o.iterations+2*o.t_eq; )
     {
@@ -1,5 +1,10 @@
 #include "SimpleSampling.hpp"
 
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 SimpleSampling::SimpleSampling(const Cmd &o)
     : Simulation(o)
 {
@@ -7,6 +12,12 @@ SimpleSampling::SimpleSampling(const Cmd &o)
 
 void SimpleSampling::run()
 {
+    if(o.perm)
+    {
+        runPERM();
+        return;
+    }
+
     UniformRNG rngMC(o.seedMC);
 
     oss << "# simple sampling simulation with steps=" << o.steps << "\n";
@@ -65,3 +76,99 @@ void SimpleSampling::run()
     if(!o.threejs_path.empty())
         w->threejs(o.threejs_path, true);
 }
+
+/** Sum of values weighted by weights, which are given by their logarithm.
+ *
+ * The sums are stored relative to exp(logNorm), the largest weight
+ * so far, such that the weights of long walks do not overflow.
+ */
+struct WeightedSum
+{
+    WeightedSum() : logNorm(-std::numeric_limits<double>::infinity()), weights(0), values(0) {}
+
+    /// adds weights and values, which are relative to exp(logW)
+    void add(double logW, double w, double v)
+    {
+        if(w == 0)
+            return;
+        if(logW > logNorm)
+        {
+            const double scale = std::exp(logNorm - logW);
+            weights *= scale;
+            values *= scale;
+            logNorm = logW;
+        }
+        const double f = std::exp(logW - logNorm);
+        weights += f * w;
+        values += f * v;
+    }
+
+    double logNorm;
+    double weights;
+    double values;
+};
+
+/** Simple sampling of self-avoiding walks with PERM.
+ *
+ * Every iteration is one tour with its own random number stream. The
+ * tours are grown in parallel in batches of fixed size, which use the
+ * estimate of the partition sums of all batches before, such that the
+ * output does not depend on the number of threads.
+ * Every generated walk is one line, the first column is the number of
+ * the tour and the last column the logarithm of the weight of the walk.
+ */
+void SimpleSampling::runPERM()
+{
+    const int batch = 64;
+
+    oss << "# PERM simulation with steps=" << o.steps << "\n";
+
+    // header
+    oss << "# tour L A";
+    oss << " r r2 maxDiameter spanX SpanY numOnHull oblateness visitedSites length stepstaken argminX argmaxX minX maxX";
+    oss << " logWeight\n";
+
+    SelfAvoidingWalker::PERMEstimate estimate, next;
+    WeightedSum total;
+    #pragma omp parallel
+    {
+        // every tour starts from scratch, an equilibrated walk is not needed
+        auto saw = new SelfAvoidingWalker(o.d, o.steps, UniformRNG(o.seedRealization), o.chAlg, true, false);
+        std::unique_ptr<Walker> w(saw);
+
+        for(int start=0; start<o.iterations; start+=batch)
+        {
+            #pragma omp for ordered schedule(dynamic)
+            for(int i=start; i<std::min(start+batch, o.iterations); ++i)
+            {
+                UniformRNG rng(o.seedRealization, i, UniformRNG::realizationStream);
+                std::stringstream ss;
+                WeightedSum sum;
+                int num = 0;
+
+                saw->tourPERM(rng, [&](double logW){
+                    write_observables(w, i, ss);
+                    ss << logW << "\n";
+                    sum.add(logW, 1, S(w));
+                    ++num;
+                }, estimate);
+
+                LOG(LOG_DEBUG) << "Tour: " << i << " samples: " << num;
+
+                #pragma omp ordered
+                {
+                    oss << ss.str() << std::flush;
+                    next.add(saw->tourEstimate());
+                    total.add(sum.logNorm, sum.weights, sum.values);
+                }
+            }
+
+            // the next batch starts after all tours of this one are finished
+            #pragma omp single
+            estimate = next;
+        }
+    }
+
+    // the average of S weighted by the PERM weights
+    checksum = total.weights > 0 ? total.values / total.weights : 0;
+}
@@ -14,6 +14,9 @@ class SimpleSampling : public Simulation
     public:
         SimpleSampling(const Cmd &o);
         virtual void run() override;
+
+    protected:
+        void runPERM();
 };
 
 #endif
@@ -19,6 +19,12 @@ Simulation::Simulation(const Cmd &o, const bool fileOutput)
         header(oss);
 
     S = prepareS(o);
+
+    // cheap bounds are only known for the hull in d=2 and they are not
+    // worth it, if the hull can be updated cheaply anyway
+    earlyRejection = o.d == 2 && o.numWalker == 1
+                     && (o.wantedObservable == WO_VOLUME || o.wantedObservable == WO_SURFACE_AREA)
+                     && o.chAlg != CH_NOP && o.chAlg != CH_1D && o.chAlg != CH_SEGMENT_TREE;
 }
 
 Simulation::~Simulation()
@@ -44,7 +50,15 @@ Simulation::~Simulation()
 
 void Simulation::prepare(std::unique_ptr<Walker>& w, const Cmd &o)
 {
-    UniformRNG rngReal(o.seedRealization);
+    if(o.philoxRN)
+        prepare(w, o, UniformRNG(o.seedRealization, 0, UniformRNG::realizationStream));
+    else
+        prepare(w, o, UniformRNG(o.seedRealization));
+}
+
+/// Constructs the walker of type o.type, its realization is drawn from rngReal.
+void Simulation::prepare(std::unique_ptr<Walker>& w, const Cmd &o, const UniformRNG &rngReal)
+{
     bool amnesia = false;
     if(o.sampling_method == SM_SIMPLESAMPLING)
         amnesia = true;
@@ -235,6 +249,9 @@ void Simulation::prepare(std::unique_ptr<Walker>& w, const Cmd &o)
         LOG(LOG_ERROR) << "type " << o.type << " is not known";
     }
 
+    if(o.onDemandRN)
+        w->setOnDemandRN();
+
     w->updateHull();
 }
 
@@ -381,7 +398,7 @@ void Simulation::footer(std::ofstream &oss)
     oss.close();
 }
 
-void Simulation::write_observables(std::unique_ptr<Walker> &w, int i, std::ofstream &oss)
+void Simulation::write_observables(std::unique_ptr<Walker> &w, int i, std::ostream &oss)
 {
     if(!oss.good())
     {
@@ -43,6 +43,27 @@
 #include "../RNG.hpp"
 #include "../io.hpp"
 
+/// \name observables as types
+/// The templated Monte Carlo kernels take one of these and the walker
+/// with its concrete type, such that S can be inlined.
+///@{
+struct ObservableL
+{
+    template <class W> double operator()(const W &w) const { return w.L(); }
+};
+
+struct ObservableA
+{
+    template <class W> double operator()(const W &w) const { return w.A(); }
+};
+
+struct ObservablePassage
+{
+    int t1;
+    template <class W> double operator()(const W &w) const { return w.passage(t1); }
+};
+///@}
+
 /** Abstract Base Class, derive classes that sample random walks.
  */
 class Simulation
@@ -53,7 +74,9 @@ class Simulation
 
         virtual void run() = 0;
         static void prepare(std::unique_ptr<Walker>& w, const Cmd &o);
+        static void prepare(std::unique_ptr<Walker>& w, const Cmd &o, const UniformRNG &rngReal);
         static std::function<double(const std::unique_ptr<Walker>&)> prepareS(const Cmd &o);
+        template <class F> static void dispatch(Walker &w, const Cmd &o, F &f);
         static double getLowerBound(Cmd &o);
         static double getUpperBound(Cmd &o);
         static double getReasonalbleUpperBound(Cmd &o);
@@ -73,6 +96,7 @@ class Simulation
         uint64_t fails;
         uint64_t tries;
         std::function<double(std::unique_ptr<Walker>&)> S;
+        bool earlyRejection; ///< reject changes by cheap bounds before updating the hull
         std::ofstream oss;
         bool muted;
         bool fileOutput;
@@ -82,10 +106,224 @@ class Simulation
         void header(std::ofstream &oss);
         void footer(std::ofstream &oss);
 
-        void write_observables(std::unique_ptr<Walker> &w, int i, std::ofstream &oss);
+        void write_observables(std::unique_ptr<Walker> &w, int i, std::ostream &oss);
+
+        template <class W, class Obs>
+        bool changeMetropolis(W &w, const Obs &S, double theta, UniformRNG &rngMC, double &s) const;
+        template <class W, class Obs>
+        int sweepMetropolis(W &w, const Obs &S, double theta, UniformRNG &rngMC, int trials) const;
+        template <class W>
+        bool changeWithinWindow(W &w, double lb, double ub, UniformRNG &rngMC) const;
+
+        /// sweepMetropolis() as functor for dispatch()
+        struct MetropolisSweep
+        {
+            MetropolisSweep(const Simulation &sim, double theta, UniformRNG &rngMC, int trials)
+                : sim(sim), theta(theta), rngMC(rngMC), trials(trials), fails(0) {}
+
+            template <class W, class Obs>
+            void operator()(W &w, const Obs &S) { fails = sim.sweepMetropolis(w, S, theta, rngMC, trials); }
+
+            const Simulation &sim;
+            double theta;
+            UniformRNG &rngMC;
+            int trials;
+            int fails; ///< rejected trials of the last sweep
+        };
 
     private:
+        template <class F, class Obs> static void dispatchWalker(Walker &w, const Cmd &o, F &f, const Obs &S);
+
         clock_t start;
 };
 
+/** Calls f(w, S) with the walker cast to its concrete type and S the
+ * observable of o.
+ *
+ * This is the only dispatch for a Monte Carlo kernel f, which has a
+ * templated operator(). Within the kernel, change(), undoChange() and
+ * S are no virtual calls anymore and can be inlined for all final
+ * walker classes. BrownianResetWalker is not final, since
+ * BrownianResetWalkerShifted derives from it, and multiple walkers are
+ * passed as Walker, both still use virtual calls.
+ */
+template <class F>
+void Simulation::dispatch(Walker &w, const Cmd &o, F &f)
+{
+    if(o.wantedObservable == WO_SURFACE_AREA)
+        dispatchWalker(w, o, f, ObservableL());
+    else if(o.wantedObservable == WO_VOLUME)
+        dispatchWalker(w, o, f, ObservableA());
+    else if(o.wantedObservable == WO_PASSAGE)
+        dispatchWalker(w, o, f, ObservablePassage{o.passageTimeStart});
+    else
+        LOG(LOG_ERROR) << "observable " << o.wantedObservable << " is not known";
+}
+
+template <class F, class Obs>
+void Simulation::dispatchWalker(Walker &w, const Cmd &o, F &f, const Obs &S)
+{
+    if(o.type == WT_SCENT_RANDOM_WALK)
+    {
+        if(o.d == 1)
+            f(dynamic_cast<ScentWalker1D&>(w), S);
+        else
+            f(dynamic_cast<ScentWalker&>(w), S);
+        return;
+    }
+
+    if(o.numWalker != 1)
+    {
+        f(w, S);
+        return;
+    }
+
+    switch(o.type)
+    {
+        case WT_RANDOM_WALK:
+            f(dynamic_cast<LatticeWalker&>(w), S);
+            break;
+        case WT_LOOP_ERASED_RANDOM_WALK:
+            f(dynamic_cast<LoopErasedWalker&>(w), S);
+            break;
+        case WT_SELF_AVOIDING_RANDOM_WALK:
+            f(dynamic_cast<SelfAvoidingWalker&>(w), S);
+            break;
+        case WT_REAL_RANDOM_WALK:
+            f(dynamic_cast<RealWalker&>(w), S);
+            break;
+        case WT_GAUSSIAN_RANDOM_WALK:
+            f(dynamic_cast<GaussWalker&>(w), S);
+            break;
+        case WT_LEVY_FLIGHT:
+            f(dynamic_cast<LevyWalker&>(w), S);
+            break;
+        case WT_CORRELATED_RANDOM_WALK:
+            f(dynamic_cast<CorrelatedWalker&>(w), S);
+            break;
+        case WT_ESCAPE_RANDOM_WALK:
+            f(dynamic_cast<EscapeWalker&>(w), S);
+            break;
+        case WT_TRUE_SELF_AVOIDING_WALK:
+            f(dynamic_cast<TrueSelfAvoidingWalker&>(w), S);
+            break;
+        case WT_RESET_WALK:
+            f(dynamic_cast<ResetWalker&>(w), S);
+            break;
+        case WT_BRANCH_WALK:
+            f(dynamic_cast<BranchingGauss&>(w), S);
+            break;
+        case WT_RUNANDTUMBLE_WALK:
+            f(dynamic_cast<RunAndTumbleWalker&>(w), S);
+            break;
+        case WT_RUNANDTUMBLE_T_WALK:
+            f(dynamic_cast<RunAndTumbleWalkerT&>(w), S);
+            break;
+        case WT_RETURNING_LATTICE_WALK:
+            f(dynamic_cast<ReturningLatticeWalker&>(w), S);
+            break;
+        case WT_GAUSSIAN_RESET_WALK:
+            f(dynamic_cast<GaussResetWalker&>(w), S);
+            break;
+        case WT_BROWNIAN_RESET_WALK:
+            f(dynamic_cast<BrownianResetWalker&>(w), S);
+            break;
+        case WT_BROWNIAN_RESET_WALK_SHIFTED:
+            f(dynamic_cast<BrownianResetWalkerShifted&>(w), S);
+            break;
+        default:
+            f(w, S);
+    }
+}
+
+/** Performs one Metropolis trial move at temperature theta.
+ *
+ * The random number for the acceptance is drawn directly after the
+ * change, such that the change can be rejected by cheap bounds on S
+ * before the hull is updated. Since the order of the random numbers is
+ * the same as without the bounds, the Markov chain is identical.
+ *
+ * \param s S of the current state, is updated to S after the trial
+ * \return Was the change accepted?
+ */
+template <class W, class Obs>
+bool Simulation::changeMetropolis(W &w, const Obs &S, const double theta, UniformRNG &rngMC, double &s) const
+{
+    if(!earlyRejection)
+    {
+        w.change(rngMC);
+        const double newS = S(w);
+        const double p_acc = std::exp((s - newS)/theta);
+        if(p_acc < rngMC())
+        {
+            w.undoChange();
+            return false;
+        }
+        s = newS;
+        return true;
+    }
+
+    w.change(rngMC, false);
+    const double r = rngMC();
+
+    // the most favorable value S can take
+    double lower, upper;
+    w.observableBounds(o.wantedObservable, lower, upper);
+    const double p_max = std::exp((s - (theta > 0 ? lower : upper))/theta);
+    if(p_max < r)
+    {
+        w.undoChange();
+        return false;
+    }
+
+    w.updateHullOfChange();
+    const double newS = S(w);
+    const double p_acc = std::exp((s - newS)/theta);
+    if(p_acc < r)
+    {
+        w.undoChange();
+        return false;
+    }
+    s = newS;
+    return true;
+}
+
+/// Performs trials Metropolis trial moves, returns the number of rejected ones.
+template <class W, class Obs>
+int Simulation::sweepMetropolis(W &w, const Obs &S, const double theta, UniformRNG &rngMC, const int trials) const
+{
+    int fails = 0;
+    double s = S(w);
+    for(int j=0; j<trials; ++j)
+        if(!changeMetropolis(w, S, theta, rngMC, s))
+            ++fails;
+    return fails;
+}
+
+/** Performs a change, which is rejected early if it leaves [lb, ub].
+ *
+ * If cheap bounds on S show, that S will be outside of the window,
+ * the hull is not updated and false is returned. Then the change needs
+ * to be undone by the caller.
+ */
+template <class W>
+bool Simulation::changeWithinWindow(W &w, const double lb, const double ub, UniformRNG &rngMC) const
+{
+    if(!earlyRejection)
+    {
+        w.change(rngMC);
+        return true;
+    }
+
+    w.change(rngMC, false);
+
+    double lower, upper;
+    w.observableBounds(o.wantedObservable, lower, upper);
+    if(upper < lb || lower > ub)
+        return false;
+
+    w.updateHullOfChange();
+    return true;
+}
+
 #endif
@@ -67,6 +67,38 @@ void WangLandau::findStart(std::unique_ptr<Walker>& w, double lb, double ub, Uni
     } while(S(w) < lb || S(w) > ub);
 }
 
+/** Wang Landau trials within [lb, ub] until the histogram H is flat.
+ *
+ * The acceptance is only evaluated inside of the window.
+ */
+template <class W, class Obs>
+void WangLandau::untilFlat(W &w, const Obs &S, Histogram &g, Histogram &H, const double lb, const double ub, const double lnf, UniformRNG &rngMC)
+{
+    double s = S(w);
+    do
+    {
+        const bool inWindow = changeWithinWindow(w, lb, ub, rngMC);
+        ++tries;
+
+        bool accepted = false;
+        if(inWindow)
+        {
+            const double newS = S(w);
+            accepted = newS >= lb && newS <= ub && std::exp(g[s] - g[newS]) >= rngMC();
+            if(accepted)
+                s = newS;
+        }
+        if(!accepted)
+        {
+            w.undoChange();
+            ++fails;
+        }
+
+        g.add(s, lnf);
+        H.add(s);
+    } while(H.min() < flatness_criterion * H.mean() || H.min() == 0);
+}
+
 void WangLandau::printCenters(const Cmd &o)
 {
     for(auto i : generateBins(o))
@@ -92,13 +124,11 @@ void WangLandau::run()
     #pragma omp parallel for schedule(dynamic)
     for(int n=0; n<o.iterations; ++n)
     {
-        // rngs should be local to the threads, with different seeds
-        // FIXME: think about a better seed
-        UniformRNG rngMC((o.seedMC+n) * (n+1));
-        o.seedRealization = ((uint64_t)(o.seedRealization + n) * (n+1)) % 1800000121;
+        // rngs should be local to the threads, every iteration has its own stream
+        UniformRNG rngMC(o.seedMC, n, UniformRNG::mcStream);
 
         std::unique_ptr<Walker> w;
-        prepare(w, o);
+        prepare(w, o, UniformRNG(o.seedRealization, n, UniformRNG::realizationStream));
 
         for(int i=0; i<num_ranges; ++i)
         {
@@ -116,30 +146,8 @@ void WangLandau::run()
             while(lnf > lnf_min)
             {
                 LOG(LOG_DEBUG) << "ln f " << lnf;
-                do
-                {
-                    double oldS = S(w);
-                    w->change(rngMC);
-                    ++tries;
-
-                    double p_acc = std::exp(g[oldS] - g[S(w)]);
-                    if(S(w) < lb || S(w) > ub || p_acc < rngMC())
-                    {
-                        w->undoChange();
-                        ++fails;
-                    }
-
-                    g.add(S(w), lnf);
-                    H.add(S(w));
-
-                    // if(tries % 100 == 0)
-                    // {
-                    //     std::ofstream osg(std::to_string(tries)+".g");
-                    //     std::ofstream osH(std::to_string(tries)+".H");
-                    //     osg << g.ascii_table();
-                    //     osH << H.ascii_table();
-                    // }
-                } while(H.min() < flatness_criterion * H.mean() || H.min() == 0);
+                UntilFlat trials(*this, g, H, lb, ub, lnf, rngMC);
+                dispatch(*w, o, trials);
                 // run until the histogram is flat and we have a few samples
                 H.reset();
                 lnf /= 2;
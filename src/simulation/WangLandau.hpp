@@ -35,6 +35,27 @@ class WangLandau : public Simulation
     protected:
         void findStart(std::unique_ptr<Walker>& w, double lb, double ub, UniformRNG& rng);
 
+        template <class W, class Obs>
+        void untilFlat(W &w, const Obs &S, Histogram &g, Histogram &H, double lb, double ub, double lnf, UniformRNG &rngMC);
+
+        /// untilFlat() as functor for dispatch()
+        struct UntilFlat
+        {
+            UntilFlat(WangLandau &sim, Histogram &g, Histogram &H, double lb, double ub, double lnf, UniformRNG &rngMC)
+                : sim(sim), g(g), H(H), lb(lb), ub(ub), lnf(lnf), rngMC(rngMC) {}
+
+            template <class W, class Obs>
+            void operator()(W &w, const Obs &S) { sim.untilFlat(w, S, g, H, lb, ub, lnf, rngMC); }
+
+            WangLandau &sim;
+            Histogram &g;
+            Histogram &H;
+            double lb;
+            double ub;
+            double lnf;
+            UniformRNG &rngMC;
+        };
+
         double lnf_min;
         double flatness_criterion;
 
@@ -3,6 +3,8 @@
 #include "../Cmd.hpp"
 #include "../walker/Walker.hpp"
 #include "../walker/LatticeWalker.hpp"
+#include "../walker/MultipleWalker.hpp"
+#include "../ConvexHull.hpp"
 #include "../simulation/Simulation.hpp"
 
 TEST_CASE( "hull types", "[hull]" ) {
@@ -42,6 +44,14 @@ TEST_CASE( "hull types", "[hull]" ) {
             w->setHullAlgo(CH_ANDREWS_AKL);
             REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
         }
+        SECTION("Graham") {
+            w->setHullAlgo(CH_GRAHAM);
+            REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
+        }
+        SECTION("Graham + Akl") {
+            w->setHullAlgo(CH_GRAHAM_AKL);
+            REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
+        }
         SECTION("Jarvis") {
             w->setHullAlgo(CH_JARVIS);
             REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
@@ -66,6 +76,14 @@ TEST_CASE( "hull types", "[hull]" ) {
             w->setHullAlgo(CH_CHAN_AKL);
             REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
         }
+        SECTION("segment tree") {
+            w->setHullAlgo(CH_SEGMENT_TREE);
+            REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
+        }
+        SECTION("column extrema") {
+            w->setHullAlgo(CH_COLUMN_EXTREMA);
+            REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
+        }
     }
     SECTION( "3D" ) {
         o.d = 3;
@@ -85,5 +103,175 @@ TEST_CASE( "hull types", "[hull]" ) {
             w->setHullAlgo(CH_QHULL_AKL);
             REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
         }
+        SECTION("native quickhull") {
+            w->setHullAlgo(CH_QUICKHULL_3D);
+            REQUIRE(w->A() == Approx(A)); REQUIRE(w->L() == Approx(L)); REQUIRE(w->num_on_hull() == count);
+        }
+    }
+}
+
+TEST_CASE( "native quickhull", "[hull]" ) {
+    // lattice points of a cube, most of them on faces and edges
+    std::vector<Step<int>> points;
+    for(int x=0; x<=4; ++x)
+        for(int y=0; y<=4; ++y)
+            for(int z=0; z<=4; ++z)
+                points.push_back(Step<int>({x, y, z}));
+
+    SECTION( "cube" ) {
+        ConvexHull<int> c(&points, CH_QUICKHULL_3D);
+        REQUIRE(c.A() == Approx(64)); REQUIRE(c.L() == Approx(96)); REQUIRE(c.num_vertices() == 8);
+    }
+    SECTION( "plane" ) {
+        // a tilted square with side length 20
+        for(auto &p : points)
+            p = Step<int>({3*p.x(), 4*p.x(), 5*p.y()});
+        ConvexHull<int> c(&points, CH_QUICKHULL_3D);
+        REQUIRE(c.A() == 0); REQUIRE(c.L() == Approx(400)); REQUIRE(c.num_vertices() == 4);
+    }
+}
+
+TEST_CASE( "rotating calipers", "[hull]" ) {
+    std::vector<Step<int>> points;
+
+    SECTION( "rectangle" ) {
+        for(int x=0; x<=4; ++x)
+            for(int y=0; y<=3; ++y)
+                points.push_back(Step<int>({x, y}));
+        ConvexHull<int> c(&points, CH_ANDREWS);
+        Calipers m = rotatingCalipers(c.hullPoints());
+        REQUIRE(m.diameter == Approx(5)); REQUIRE(m.width == Approx(3)); REQUIRE(m.minRectangle == Approx(12));
+    }
+    SECTION( "tilted square" ) {
+        // the axis parallel bounding box has an area of 49
+        points = {Step<int>({0, 0}), Step<int>({4, 3}), Step<int>({1, 7}), Step<int>({-3, 4}), Step<int>({1, 3})};
+        ConvexHull<int> c(&points, CH_ANDREWS);
+        Calipers m = rotatingCalipers(c.hullPoints());
+        REQUIRE(m.diameter == Approx(std::sqrt(50))); REQUIRE(m.width == Approx(5)); REQUIRE(m.minRectangle == Approx(25));
+    }
+}
+
+/// The hull of w has to match a hull of the sum of its steps from scratch.
+template <class T>
+void requireHullOfSteps(const SpecWalker<T> &w)
+{
+    std::vector<Step<T>> points(1, Step<T>(w.d));
+    for(const auto &step : w.steps())
+        points.push_back(points.back() + step);
+
+    ConvexHull<T> c(&points, CH_ANDREWS);
+    REQUIRE(w.A() == Approx(c.A()));
+    REQUIRE(w.L() == Approx(c.L()));
+    REQUIRE(w.num_on_hull() == c.num_vertices());
+}
+
+TEST_CASE( "hull updates", "[hull]" ) {
+    Cmd o;
+    o.seedRealization = 13;
+    o.d = 2;
+    o.steps = 1000;
+    o.numWalker = 1;
+    o.chAlg = CH_SEGMENT_TREE;
+
+    UniformRNG rng(42);
+    std::unique_ptr<Walker> w;
+
+    SECTION( "lattice" ) {
+        o.type = WT_RANDOM_WALK;
+    }
+    SECTION( "Gaussian" ) {
+        o.type = WT_GAUSSIAN_RANDOM_WALK;
+    }
+    SECTION( "self-avoiding" ) {
+        o.type = WT_SELF_AVOIDING_RANDOM_WALK;
+    }
+    SECTION( "returning" ) {
+        o.type = WT_RETURNING_LATTICE_WALK;
+        o.sampling_method = SM_METROPOLIS;
+    }
+    SECTION( "resetting" ) {
+        o.type = WT_RESET_WALK;
+        o.resetrate = 0.2;
+        o.sampling_method = SM_METROPOLIS;
+    }
+
+    Simulation::prepare(w, o);
+
+    // the partially updated hull needs to match a hull from scratch,
+    // without rebuilding the tree or applying the pending translations
+    for(int i=0; i<200; ++i)
+    {
+        w->change(rng);
+        if(rng() < 0.5)
+            w->undoChange();
+
+        if(o.type == WT_GAUSSIAN_RANDOM_WALK)
+            requireHullOfSteps(dynamic_cast<SpecWalker<double>&>(*w));
+        else
+            requireHullOfSteps(dynamic_cast<SpecWalker<int>&>(*w));
+    }
+}
+
+TEST_CASE( "hull unions", "[hull]" ) {
+    UniformRNG rng(42);
+
+    SECTION( "parts" ) {
+        const int k = 7;
+        std::vector<std::vector<Step<int>>> parts(k);
+        std::vector<const std::vector<Step<int>>*> pointers;
+        for(auto &p : parts)
+        {
+            p.resize(20, Step<int>(2));
+            for(auto &s : p)
+                s = Step<int>({(int) (rng() * 100), (int) (rng() * 100)});
+            pointers.push_back(&p);
+        }
+
+        ConvexHull<int> u(CH_ANDREWS);
+        u.runUnion(pointers);
+
+        std::vector<Step<int>> all;
+        for(int i=0; i<200; ++i)
+        {
+            const double A = u.A(), L = u.L();
+
+            // move one part and maybe undo it
+            const int j = rng() * k;
+            const std::vector<Step<int>> old = parts[j];
+            for(auto &s : parts[j])
+                s = Step<int>({(int) (rng() * 150), (int) (rng() * 150)});
+            u.beginTrial();
+            u.runUnion(pointers, j);
+            if(rng() < 0.5)
+            {
+                parts[j] = old;
+                u.rollback();
+                REQUIRE(u.A() == A); REQUIRE(u.L() == L);
+            }
+
+            all.clear();
+            for(const auto &p : parts)
+                all.insert(all.end(), p.begin(), p.end());
+            ConvexHull<int> c(&all, CH_ANDREWS);
+            REQUIRE(u.A() == Approx(c.A())); REQUIRE(u.L() == Approx(c.L()));
+            REQUIRE(u.num_vertices() == c.num_vertices());
+        }
+    }
+
+    SECTION( "multiple walkers" ) {
+        MultipleWalker<LatticeWalker> w(2, 300, 10, UniformRNG(13), CH_ANDREWS);
+        for(int i=0; i<100; ++i)
+        {
+            w.change(rng, i % 3 != 0);
+            if(i % 3 == 0)
+                w.updateHull();
+            if(rng() < 0.5)
+                w.undoChange();
+
+            // without a change, the union is built from scratch
+            const double A = w.A(), L = w.L();
+            w.updateHull();
+            REQUIRE(w.A() == Approx(A)); REQUIRE(w.L() == Approx(L));
+        }
     }
 }
@@ -51,6 +51,63 @@ TEST_CASE( "observables", "[walk]" ) {
         REQUIRE(w.enclosedSites() == 20);
         REQUIRE(w.num_resets() == 0);
         REQUIRE(w.maxsteps_partialwalk() == o.steps);
+
+        double lower, upper;
+        w.observableBounds(WO_VOLUME, lower, upper);
+        REQUIRE(lower <= w.A()); REQUIRE(w.A() <= upper);
+        w.observableBounds(WO_SURFACE_AREA, lower, upper);
+        REQUIRE(lower <= w.L()); REQUIRE(w.L() <= upper);
+
+        // the cached extremes of lazily translated points give the same bounds
+        LatticeWalker v(2, 1000, rngReal, CH_SEGMENT_TREE);
+        UniformRNG rngMC(13);
+        for(int i=0; i<200; ++i)
+        {
+            v.change(rngMC, false);
+            LatticeWalker scanned(v);
+            scanned.points();
+            for(auto observable : {WO_VOLUME, WO_SURFACE_AREA})
+            {
+                double lowerScanned, upperScanned;
+                v.observableBounds(observable, lower, upper);
+                scanned.observableBounds(observable, lowerScanned, upperScanned);
+                REQUIRE(lower == lowerScanned);
+                REQUIRE(upper == upperScanned);
+            }
+
+            if(rngMC() < 0.5)
+            {
+                v.undoChange();
+                continue;
+            }
+            v.updateHullOfChange();
+            v.observableBounds(WO_VOLUME, lower, upper);
+            REQUIRE(lower <= v.A()); REQUIRE(v.A() <= upper);
+            v.observableBounds(WO_SURFACE_AREA, lower, upper);
+            REQUIRE(lower <= v.L()); REQUIRE(v.L() <= upper);
+        }
+
+        // a change, which keeps the step, does not calculate the hull,
+        // also not after a rejected change
+        LatticeWalker u(2, 100, rngReal, CH_ANDREWS);
+        int unchanged = 0;
+        for(int i=0; i<200; ++i)
+        {
+            const std::vector<Step<int>> before = u.steps();
+            u.change(rngMC, false);
+            if(u.steps() == before)
+            {
+                const int runs = u.convexHull().num_runs();
+                u.updateHullOfChange();
+                REQUIRE(u.convexHull().num_runs() == runs);
+                ++unchanged;
+            }
+            else if(rngMC() < 0.5)
+                u.undoChange();
+            else
+                u.updateHullOfChange();
+        }
+        REQUIRE(unchanged > 0);
     }
     SECTION( "3D" ) {
         o.d = 3;
@@ -82,8 +139,8 @@ TEST_CASE( "observables", "[walk]" ) {
         o.numWalker = 3;
         MultipleWalker<LatticeWalker> w(o.d, o.steps, o.numWalker, rngReal, o.chAlg);
 
-        REQUIRE(w.A() == Approx(52.5));
-        REQUIRE(w.L() == Approx(29.3203279176));
+        REQUIRE(w.A() == Approx(72.0));
+        REQUIRE(w.L() == Approx(33.8339114269));
         REQUIRE(w.maxDiameter() == 0); // not implemented
         REQUIRE(w.r() == 0); // not implemented
         REQUIRE(w.r2() == 0); // not implemented
@@ -102,29 +159,29 @@ TEST_CASE( "observables", "[walk]" ) {
         o.d = 2;
         GaussWalker w(o.d, o.steps, rngReal, o.chAlg);
 
-        REQUIRE(w.A() == Approx(21.8773286989));
-        REQUIRE(w.L() == Approx(18.426591087));
+        REQUIRE(w.A() == Approx(15.2687328308));
+        REQUIRE(w.L() == Approx(16.6034989917));
         REQUIRE(w.L() > 2*w.maxDiameter());
-        REQUIRE(w.maxDiameter() == Approx(7.0414677753));
-        REQUIRE(w.r() == Approx(4.0898932942));
+        REQUIRE(w.maxDiameter() == Approx(7.1391076487));
+        REQUIRE(w.r() == Approx(2.763057118));
         REQUIRE(w.r()*w.r() == Approx(w.r2()));
-        REQUIRE(w.r2() == Approx(16.7272271581));
+        REQUIRE(w.r2() == Approx(7.6344846374));
         REQUIRE(w.r() >= std::abs(w.rx()));
         REQUIRE(w.r() >= std::abs(w.ry()));
-        REQUIRE(w.rx() == Approx(-2.2268209858));
-        REQUIRE(w.ry() == Approx(3.4305240788));
-        REQUIRE(w.num_on_hull() == 7);
-        REQUIRE(w.oblateness() == Approx(1.4028496121));
-        REQUIRE(w.length() == Approx(40.3715617656));
+        REQUIRE(w.rx() == Approx(0.0564824378));
+        REQUIRE(w.ry() == Approx(-2.7624797505));
+        REQUIRE(w.num_on_hull() == 8);
+        REQUIRE(w.oblateness() == Approx(1.4457548874));
+        REQUIRE(w.length() == Approx(35.3910825959));
         REQUIRE(w.steps_taken() == o.steps);
-        REQUIRE(w.argminx() == 7);
-        REQUIRE(w.argmaxx() == 3);
-        REQUIRE(w.minx() == Approx(-3.2200234575));
-        REQUIRE(w.maxx() == Approx(2.9965956775));
+        REQUIRE(w.argminx() == 10);
+        REQUIRE(w.argmaxx() == 16);
+        REQUIRE(w.minx() == Approx(-1.4477554126));
+        REQUIRE(w.maxx() == Approx(2.6515418215));
         REQUIRE(w.visitedSites() == -1); // not implemented
         REQUIRE(w.enclosedSites() == -1); // not implemented
         REQUIRE(w.num_resets() == 0);
         REQUIRE(w.maxsteps_partialwalk() == o.steps);
-        REQUIRE(w.maxlen_partialwalk() == Approx(40.3715617656));
+        REQUIRE(w.maxlen_partialwalk() == Approx(35.3910825959));
     }
 }
@@ -0,0 +1,212 @@
+#include <catch.hpp>
+
+#include "../RNG.hpp"
+
+/// skips draws of OnDemandRN, to test more than 2^32 of them
+struct SkippingOnDemandRN : public OnDemandRN
+{
+    using OnDemandRN::OnDemandRN;
+    void skip(uint64_t z) { draws += z; }
+    size_t highWords() const { return high.size(); }
+};
+
+TEST_CASE( "random number generators", "[rng]" ) {
+    SECTION( "Philox4x32 known answers" ) {
+        // test vectors of the reference implementation Random123
+        uint32_t out[4];
+        const uint32_t ctr1[4] = {0, 0, 0, 0};
+        const uint32_t key1[2] = {0, 0};
+        Philox4x32::bijection(ctr1, key1, out);
+        REQUIRE(out[0] == 0x6627e8d5); REQUIRE(out[1] == 0xe169c58d); REQUIRE(out[2] == 0xbc57ac4c); REQUIRE(out[3] == 0x9b00dbd8);
+
+        const uint32_t ctr2[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+        const uint32_t key2[2] = {0xa4093822, 0x299f31d0};
+        Philox4x32::bijection(ctr2, key2, out);
+        REQUIRE(out[0] == 0xd16cfe09); REQUIRE(out[1] == 0x94fdcceb); REQUIRE(out[2] == 0x5001e420); REQUIRE(out[3] == 0x24126ea1);
+    }
+    SECTION( "skip ahead" ) {
+        UniformRNG a(42, 3, 1), b(42, 3, 1);
+        for(int i=0; i<7; ++i)
+            a();
+        // every uniform number consumes two words
+        b.discard(14);
+        REQUIRE(a() == b());
+    }
+    SECTION( "size" ) {
+        // the Mersenne Twister is stored out of line
+        REQUIRE(sizeof(UniformRNG) < 100);
+        UniformRNG a(42), b(a);
+        REQUIRE(a() == b());
+        UniformRNG c(42, 0, 0);
+        c = a;
+        REQUIRE(b() == c());
+    }
+    SECTION( "streams" ) {
+        UniformRNG a(42, 0, 0), b(42, 1, 0), c(42, 0, 1);
+        const double x = a();
+        REQUIRE(x != b());
+        REQUIRE(x != c());
+        REQUIRE(UniformRNG(42, 0, 0).substream(1)() == UniformRNG(42, 0, 1)());
+
+        // the substreams of a Mersenne Twister depend on its position
+        UniformRNG t1(42), t2(42);
+        t2();
+        REQUIRE(t1.substream(1)() == UniformRNG(42).substream(1)());
+        REQUIRE(t1.substream(1)() != t2.substream(1)());
+        REQUIRE(t1() == UniformRNG(42)());
+
+        // equal seeds for the realization and the Monte Carlo moves
+        UniformRNG mc(7, 2, UniformRNG::mcStream);
+        UniformRNG real(7, 2, UniformRNG::realizationStream);
+        std::vector<double> u = mc.vector(100), v = real.vector(100);
+        int equal = 0;
+        for(int i=0; i<100; ++i)
+            equal += u[i] == v[i];
+        REQUIRE(equal == 0);
+        for(uint32_t i=1; i<=100; ++i)
+        {
+            const double x = real.substream(i)();
+            REQUIRE(x != UniformRNG(7, 2, UniformRNG::mcStream)());
+            REQUIRE(x != UniformRNG(7, 2, UniformRNG::realizationStream)());
+        }
+    }
+    SECTION( "serialization" ) {
+        UniformRNG a(42, 3, 1);
+        a();
+        std::string s = a.serialize_rng();
+        REQUIRE(s == "philox4x32 42 3 1 2");
+        UniformRNG b(13);
+        b.deserialize_rng(s);
+        REQUIRE(a() == b());
+
+        // the Mersenne Twister keeps the format of the standard library
+        UniformRNG c(13), d(42);
+        s = c.serialize_rng();
+        d.deserialize_rng(s);
+        REQUIRE(c() == d());
+
+        // the second value of a Box-Muller pair is part of the state
+        c.gaussian();
+        s = c.serialize_rng();
+        d.deserialize_rng(s);
+        REQUIRE(c.gaussian() == d.gaussian());
+        REQUIRE(c.gaussian() == d.gaussian());
+    }
+    SECTION( "bulk generation" ) {
+        UniformRNG a(42, 3, 1);
+        // start within a block
+        a.discard(3);
+        UniformRNG b(a);
+
+        std::vector<double> v(1001);
+        a.fill(v);
+        for(double x : v)
+            REQUIRE(x == b());
+
+        UniformRNG c(a);
+        // both values of the Box-Muller pairs are the scalar ones
+        a.fill_gaussian(v);
+        for(double x : v)
+            REQUIRE(x == c.gaussian());
+        REQUIRE(a.gaussian() == c.gaussian());
+        REQUIRE(a() == c());
+
+        // also for the Mersenne Twister, starting with a kept value
+        UniformRNG e(42);
+        e.gaussian();
+        UniformRNG f(e);
+        e.fill_gaussian(v);
+        for(double x : v)
+            REQUIRE(x == f.gaussian());
+
+        double sum = 0, sum2 = 0;
+        v = a.vector_gaussian(100000, 1., 2.);
+        for(double x : v)
+        {
+            sum += x;
+            sum2 += x*x;
+        }
+        REQUIRE(sum / v.size() == Approx(1.).epsilon(0.02));
+        REQUIRE(sum2 / v.size() - 1. == Approx(4.).epsilon(0.02));
+    }
+    SECTION( "on demand" ) {
+        OnDemandRN r(42, 0, 3);
+        std::vector<double> v(1, r[1]);
+        for(int i=0; i<300; ++i)
+        {
+            r.renew(1);
+            v.push_back(r[1]);
+            REQUIRE(v.back() != v.front());
+        }
+        // a rejected proposal is restored, but never proposed again
+        const double rejected = r[1];
+        r.restore(1);
+        REQUIRE(r[1] == v[299]);
+        r.renew(1);
+        REQUIRE(r[1] != rejected);
+        REQUIRE(r[1] != v[299]);
+        r.restore(1);
+        REQUIRE_THROWS(r.restore(1));
+
+        // unchanged entries keep their values
+        OnDemandRN s(42, 0, 3);
+        const double first = s[1];
+        s.renew(1);
+        s.restore(1);
+        REQUIRE(s[1] == first);
+        REQUIRE(s[2] == OnDemandRN(42, 0, 3)[2]);
+        REQUIRE(r[0] == OnDemandRN(42, 0, 3)[0]);
+
+        r.regenerate();
+        REQUIRE(r[1] != v[0]);
+        REQUIRE(r[0] != OnDemandRN(42, 0, 3)[0]);
+
+        // the draws do not wrap around after 2^32 renewals
+        SkippingOnDemandRN t(42, 0, 3);
+        const double initial0 = t[0], initial1 = t[1];
+        t.skip(0xffffffff - 2);
+        std::vector<double> renewed(1, initial1);
+        for(int i=0; i<4; ++i)
+        {
+            t.renew(1);
+            for(double x : renewed)
+                REQUIRE(t[1] != x);
+            renewed.push_back(t[1]);
+        }
+        // the last renew() crossed 2^32 draws, the entries keep their values
+        REQUIRE(t[0] == initial0);
+        t.renew(0);
+        REQUIRE(t[0] != initial0);
+        t.restore(0);
+        REQUIRE(t[0] == initial0);
+        REQUIRE(t[1] == renewed.back());
+        // only the entries renewed after 2^32 draws store their high word
+        REQUIRE(t.highWords() == 1);
+        t.regenerate();
+        REQUIRE(t.highWords() == 0);
+        REQUIRE(t[1] != renewed.back());
+    }
+    SECTION( "gaussian on demand" ) {
+        // entries of three numbers, two of them from one block
+        OnDemandRN g(42, 0, 10000, 3, true);
+        double x[3];
+        g.fill(7, x);
+        for(int k=0; k<3; ++k)
+            REQUIRE(x[k] == g(7, k));
+        g.renew(7);
+        REQUIRE(g(7, 2) != x[2]);
+        g.restore(7);
+        REQUIRE(g(7, 2) == x[2]);
+
+        double sum = 0, sum2 = 0;
+        for(int i=0; i<g.size(); ++i)
+            for(int k=0; k<g.width(); ++k)
+            {
+                sum += g(i, k);
+                sum2 += g(i, k) * g(i, k);
+            }
+        const int n = g.size() * g.width();
+        REQUIRE(sum / n == Approx(0.).margin(0.02));
+        REQUIRE(sum2 / n == Approx(1.).epsilon(0.02));
+    }
+}
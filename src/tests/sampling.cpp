@@ -60,7 +60,7 @@ TEST_CASE( "sampling types", "[sampling]" ) {
         o.iterations = 1;
         o.steps = 100;
         o.sweep = o.steps;
-        checksum = 131.0506230333;
+        checksum = 123.3803168692;
         s = std::unique_ptr<WangLandau>(new WangLandau(o));
     }
     SECTION( "Fast Wang landau + entropic" ) {
@@ -68,14 +68,14 @@ TEST_CASE( "sampling types", "[sampling]" ) {
         o.iterations = 1;
         o.steps = 100;
         o.sweep = o.steps;
-        checksum = 137.9641392872;
+        checksum = 65.3125000002;
         s = std::unique_ptr<FastWLEntropic>(new FastWLEntropic(o));
     }
     SECTION( "Parallel Tempering" ) {
         o.sampling_method = SM_METROPOLIS_PARALLEL_TEMPERING;
         o.steps = 100;
         o.sweep = o.steps;
-        checksum = 11021.0;
+        checksum = 11234.0;
         s = std::unique_ptr<MetropolisParallelTempering>(new MetropolisParallelTempering(o));
     }
     SECTION( "Metropolis Auto-Equilibration" ) {
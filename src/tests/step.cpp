@@ -1,6 +1,7 @@
 #include <catch.hpp>
 
 #include "../Step.hpp"
+#include "../LatticeMap.hpp"
 
 TEST_CASE("Step is tested", "[step]" ) {
     SECTION( "length" ) {
@@ -97,3 +98,58 @@ TEST_CASE("Step is tested", "[step]" ) {
         REQUIRE( diagonal3 == set_diagonal3 );
     }
 }
+
+TEST_CASE("lattice map", "[step]" ) {
+    LatticeMap<int> m;
+    std::unordered_map<Step<int>, int> reference;
+
+    // a spiral, enough to grow the table a few times
+    Step<int> p({0, 0});
+    Step<int> dir({1, 0});
+    for(int i=0; i<1000; ++i)
+    {
+        if(i % 7 == 0)
+            dir = dir.left_turn();
+        p += dir;
+        m[p] += i;
+        reference[p] += i;
+    }
+    REQUIRE( m.size() == reference.size() );
+    for(const auto &kv : reference)
+        REQUIRE( *m.find(kv.first) == kv.second );
+
+    REQUIRE( !m.insert(p, -1) );
+    REQUIRE( m.find(Step<int>({1000, 1000})) == nullptr );
+
+    m.clear();
+    REQUIRE( m.size() == 0 );
+    REQUIRE( !m.count(p) );
+    REQUIRE( m.insert(p, -1) );
+    REQUIRE( m[p] == -1 );
+
+    // far apart sites do not fit into a dense box
+    REQUIRE( m.dense() );
+    for(int i=0; i<100; ++i)
+        m[Step<int>({1000*i, -i})] = i;
+    REQUIRE( !m.dense() );
+    REQUIRE( m.size() == 101 );
+    REQUIRE( m[p] == -1 );
+    for(int i=0; i<100; ++i)
+        REQUIRE( *m.find(Step<int>({1000*i, -i})) == i );
+
+    // erasing must not break the probe sequences of the other entries
+    for(int i=0; i<100; i+=3)
+        REQUIRE( m.erase(Step<int>({1000*i, -i})) );
+    REQUIRE( !m.erase(Step<int>({0, 0})) );
+    REQUIRE( m.size() == 67 );
+    for(int i=0; i<100; ++i)
+        REQUIRE( m.count(Step<int>({1000*i, -i})) == (i % 3 != 0) );
+
+    LatticeMap<int> dense;
+    dense[p] = 1;
+    REQUIRE( dense.erase(p) );
+    REQUIRE( !dense.erase(p) );
+    REQUIRE( dense.size() == 0 );
+    REQUIRE( dense.insert(p, 2) );
+    REQUIRE( dense[p] == 2 );
+}
@@ -1,9 +1,12 @@
 #include <catch.hpp>
 
+#include <functional>
+
 #include "../Cmd.hpp"
 #include "../walker/Walker.hpp"
 #include "../walker/LatticeWalker.hpp"
 #include "../walker/LoopErasedWalker.hpp"
+#include "../walker/TrueSelfAvoidingWalker.hpp"
 #include "../walker/SelfAvoidingWalker.hpp"
 #include "../walker/RealWalker.hpp"
 #include "../walker/GaussWalker.hpp"
@@ -12,6 +15,8 @@
 #include "../walker/RunAndTumbleWalker.hpp"
 #include "../walker/RunAndTumbleWalkerT.hpp"
 #include "../walker/ReturningLatticeWalker.hpp"
+#include "../walker/EscapeWalker.hpp"
+#include "../walker/ScentWalker.hpp"
 #include "../simulation/Simulation.hpp"
 #include "../simulation/SimpleSampling.hpp"
 #include "../simulation/Metropolis.hpp"
@@ -35,6 +40,57 @@ double MCMC_sampling(Cmd o)
     return s.check();
 }
 
+/// The hull of w in d=2 has to match a hull of its points from scratch.
+template<class W>
+void requireHull(const W &w)
+{
+    if(w.d != 2)
+        return;
+
+    auto points = w.points();
+    ConvexHull<decltype(W::T_type())> c(&points, CH_ANDREWS);
+    REQUIRE( w.A() == Approx(c.A()) );
+    REQUIRE( w.L() == Approx(c.L()) );
+    REQUIRE( w.num_on_hull() == c.num_vertices() );
+}
+
+/** Changes w and undoes the change many times.
+ *
+ * Every change and undo has to yield the hull of the points, which
+ * checks the partial updates and the rollback of CH_SEGMENT_TREE, and
+ * every undo has to restore the points. Every rebuildEvery-th change
+ * has to match a walk built from scratch, on which check tests walker
+ * specific invariants.
+ */
+template<class W>
+void checkChangeUndo(W &w, int rebuildEvery, std::function<void(const W&)> check=nullptr)
+{
+    UniformRNG rngMC(13);
+    for(int i=0; i<200; ++i)
+    {
+        const auto before = w.points();
+        const double A = w.A();
+        w.change(rngMC);
+        const auto after = w.points();
+        requireHull(w);
+
+        if(i % rebuildEvery == 0)
+        {
+            w.updateSteps();
+            w.updatePoints();
+            REQUIRE( w.points() == after );
+            if(check)
+                check(w);
+        }
+
+        w.undoChange();
+        REQUIRE( w.points() == before );
+        REQUIRE( w.A() == A );
+        requireHull(w);
+        w.change(rngMC);
+    }
+}
+
 TEST_CASE( "walk types", "[walk]" ) {
     Cmd o;
     o.seedRealization = 13;
@@ -116,24 +172,24 @@ TEST_CASE( "walk types", "[walk]" ) {
         o.type = WT_GAUSSIAN_RANDOM_WALK;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(31.866471759, 185.5809789266)
+            DO(33.6037321129, 122.2847925449)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(97.3490964514, 3737.0787245416)
+            DO(94.6647852045, 3804.5325972395)
         }
     }
     SECTION( "Real" ) {
         o.type = WT_REAL_RANDOM_WALK;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(16.7933274792, 50.9012134021)
+            DO(16.9271788229, 50.7883020866)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(19.2329672236, 30.3348949734)
+            DO(19.0839122882, 30.4358328447)
         }
     }
     // SECTION( "Levy" ) {
@@ -154,12 +210,12 @@ TEST_CASE( "walk types", "[walk]" ) {
         o.type = WT_CORRELATED_RANDOM_WALK;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(12.6226044285, 17.1042609018)
+            DO(12.4818340555, 17.7384097726)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(9.8537841832, 13.3748261316)
+            DO(9.4711509421, 12.397789916)
         }
     }
     SECTION( "Agent" ) {
@@ -262,12 +318,12 @@ TEST_CASE( "walk types", "[walk]" ) {
         o.type = WT_BRANCH_WALK;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(13.8732059507, 15.2605265458)
+            DO(33.4347417084, 36.7782158792)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(118.2958629731, 130.1254492704)
+            DO(107.6329026126, 118.3961928738)
         }
     }
     SECTION( "run-and-tumble" ) {
@@ -275,24 +331,24 @@ TEST_CASE( "walk types", "[walk]" ) {
         SECTION( "2D, gamma = 1" ) {
             o.d = 2;
             o.gamma = 1.0;
-            DO(30.2189224613, 1108.8955173997)
+            DO(30.849722651, 179.3408254027)
         }
         SECTION( "2D, gamma = 0.5" ) {
             o.d = 2;
             o.gamma = 0.5;
-            DO(120.8756898452, 8018.9229082423)
+            DO(123.398890604, 8285.3747172964)
         }
         SECTION( "3, gamma = 1" ) {
             o.d = 3;
             o.gamma = 1.0;
             o.chAlg = CH_QHULL;
-            DO(35.8831267428, 437.2901145499)
+            DO(38.0279424498, 275.4774245581)
         }
         SECTION( "3, gamma = 0.5" ) {
             o.d = 3;
             o.gamma = 0.5;
             o.chAlg = CH_QHULL;
-            DO(287.0650139422, 119367.451631576)
+            DO(304.2235395985, 118942.9023116276)
         }
     }
     SECTION( "run-and-tumble, fixed t" ) {
@@ -301,24 +357,24 @@ TEST_CASE( "walk types", "[walk]" ) {
         SECTION( "2D, gamma = 1" ) {
             o.d = 2;
             o.gamma = 1.0;
-            DO(26.7436202353, 55.1539760809)
+            DO(27.7918419168, 61.0949862424)
         }
         SECTION( "2D, gamma = 0.5" ) {
             o.d = 2;
             o.gamma = 0.5;
-            DO(44.9899649586, 96.7697869833)
+            DO(42.151553339, 92.2408336086)
         }
         SECTION( "3D, gamma = 1" ) {
             o.d = 3;
             o.gamma = 1.0;
             o.chAlg = CH_QHULL;
-            DO(33.7755411132, 80.3887613502)
+            DO(34.1735978295, 110.8659396687)
         }
         SECTION( "3D, gamma = 0.5" ) {
             o.d = 3;
             o.gamma = 0.5;
             o.chAlg = CH_QHULL;
-            DO(54.3861179925, 163.407527559)
+            DO(55.5477227709, 186.8956576092)
         }
     }
     SECTION( "Returning RW" ) {
@@ -338,12 +394,12 @@ TEST_CASE( "walk types", "[walk]" ) {
         o.resetrate = 0.2;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(26.515668687, 236.1484821327)
+            DO(27.204747961, 168.7224099534)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(65.8120971397, 2635.2839025648)
+            DO(67.1887363756, 3135.0787862242)
         }
     }
     SECTION( "Resetting Brownian motion" ) {
@@ -353,23 +409,23 @@ TEST_CASE( "walk types", "[walk]" ) {
         // steps == total time is identical to gaussian resetting
         SECTION( "2D" ) {
             o.d = 2;
-            DO(26.515668687, 236.1484821327)
+            DO(27.204747961, 168.7224099534)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(65.8120971397, 2635.2839025648)
+            DO(67.1887363756, 3135.0787862242)
         }
         // a high number of steps will approximate Brownian motion
         o.steps = 300;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(33.6665845282, 202.367627747)
+            DO(35.7798334702, 105.7609063817)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(117.4722305731, 2081.6400864919)
+            DO(104.2070127701, 5608.9185895314)
         }
     }
     SECTION( "Resetting Brownian motion with shift" ) {
@@ -380,31 +436,31 @@ TEST_CASE( "walk types", "[walk]" ) {
         // steps == total time is identical to gaussian resetting
         SECTION( "2D" ) {
             o.d = 2;
-            DO(32.5634604871, 113.4342743486)
+            DO(33.1909166954, 172.6073971312)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(88.5169040252, 2394.638451975)
+            DO(88.6265567266, 2899.4088388247)
         }
         // a high number of steps will approximate Brownian motion
         o.steps = 300;
         o.shift = 50;
         SECTION( "2D" ) {
             o.d = 2;
-            DO(40.7282587149, 203.5883727777)
+            DO(43.0158900213, 217.6696188027)
         }
         SECTION( "3D" ) {
             o.d = 3;
             o.chAlg = CH_QHULL;
-            DO(154.6972208826, 9750.8507401877)
+            DO(147.0161483009, 8122.0318203254)
         }
     }
     SECTION( "Multi" ) {
         o.type = WT_RANDOM_WALK;
         o.numWalker = 3;
         o.d = 2;
-        DO(58.125, 361.53)
+        DO(57.91, 424.365)
     }
 }
 
@@ -457,6 +513,78 @@ TEST_CASE( "misc", "[walk]" ) {
         REQUIRE( w.A() == 52.5 );
     }
 
+    SECTION( "SAW-tree" ) {
+        // (0,0) -> (1,0) -> (1,1) -> (0,1)
+        std::vector<Step<int>> steps = {Step<int>({1, 0}), Step<int>({0, 1}), Step<int>({-1, 0})};
+        SAWTree t(2);
+        t.build(steps);
+        REQUIRE( !t.intersects(0) );
+
+        // step back onto (1,0)
+        t.setStep(2, Step<int>({0, -1}));
+        REQUIRE( t.intersects(2) );
+        t.setStep(2, steps[2]);
+
+        // mirror at the x-axis behind (1,0)
+        const int mirror[] = {1, 0, 0, -1};
+        t.transformSuffix(1, SAWTree::symmetry(mirror, 2));
+        REQUIRE( !t.intersects(1) );
+        REQUIRE( t.end() == Step<int>({0, -1}) );
+        t.transformSuffix(1, SAWTree::inverse(SAWTree::symmetry(mirror, 2)));
+        REQUIRE( t.end() == Step<int>({0, 1}) );
+    }
+
+    SECTION( "SAW hull of the tree" ) {
+        // long enough for some levels of hulls in the tree
+        SelfAvoidingWalker w(2, 300, rngReal, CH_ANDREWS_AKL);
+        UniformRNG rngMC(13);
+        for(int i=0; i<200; ++i)
+        {
+            const auto before = w.points();
+            const double A = w.A();
+            w.change(rngMC, i % 2);
+            if(i % 2 == 0)
+                w.updateHullOfChange();
+            requireHull(w);
+            REQUIRE( w.visitedSites() == 301 );
+
+            w.undoChange();
+            REQUIRE( w.points() == before );
+            REQUIRE( w.A() == A );
+            requireHull(w);
+            w.change(rngMC);
+        }
+    }
+
+    SECTION( "PERM" ) {
+        SelfAvoidingWalker w(2, 12, rngReal, CH_ANDREWS_AKL, true);
+        SelfAvoidingWalker::PERMEstimate estimate;
+        bool selfAvoiding = true;
+        double maxLogW = 0;
+        std::vector<std::pair<double, double>> samples;
+        for(int i=0; i<500; ++i)
+        {
+            UniformRNG rng(42, i, 0);
+            w.tourPERM(rng, [&](double logW){
+                selfAvoiding &= w.visitedSites() == 13;
+                maxLogW = std::max(maxLogW, logW);
+                samples.emplace_back(logW, w.r2());
+            }, estimate);
+            estimate.add(w.tourEstimate());
+        }
+        REQUIRE( selfAvoiding );
+
+        double sumW = 0, sumR2 = 0;
+        for(const auto &s : samples)
+        {
+            sumW += std::exp(s.first - maxLogW);
+            sumR2 += std::exp(s.first - maxLogW) * s.second;
+        }
+        // exact enumeration: 324932 walks with <r^2> = 34.187
+        REQUIRE( std::log(sumW) + maxLogW - std::log(500.) == Approx(std::log(324932.)).epsilon(0.01) );
+        REQUIRE( sumR2 / sumW == Approx(34.187).epsilon(0.05) );
+    }
+
     SECTION( "Run-and-tumble fixed-t" ) {
         double t = 103.4;
         RunAndTumbleWalkerT w(2, 30, rngReal, CH_ANDREWS_AKL, true);
@@ -478,17 +606,143 @@ TEST_CASE( "misc", "[walk]" ) {
         GaussResetWalker w(2, 30, rngReal, CH_ANDREWS_AKL, true);
         w.setP1(r);
         w.reconstruct();
-        REQUIRE( w.num_resets() == 4 );
-        REQUIRE( w.maxsteps_partialwalk() == 12 );
-        REQUIRE( w.maxlen_partialwalk() == Approx(20.7990736912) );
+        REQUIRE( w.num_resets() == 2 );
+        REQUIRE( w.maxsteps_partialwalk() == 24 );
+        REQUIRE( w.maxlen_partialwalk() == Approx(34.3024867914) );
     }
     SECTION( "Resetting Walk (Brownian)" ) {
         BrownianResetWalker w(2, 30, rngReal, CH_ANDREWS_AKL, true);
         w.setP1(r);
         w.reconstruct();
-        REQUIRE( w.num_resets() == 4 );
-        REQUIRE( w.maxsteps_partialwalk() == 12 );
-        REQUIRE( w.maxlen_partialwalk() == Approx(20.7990736912) );
+        REQUIRE( w.num_resets() == 2 );
+        REQUIRE( w.maxsteps_partialwalk() == 24 );
+        REQUIRE( w.maxlen_partialwalk() == Approx(34.3024867914) );
+    }
+
+    SECTION( "Lattice Walk with random numbers on demand" ) {
+        LatticeWalker w(2, 1000, rngReal, CH_ANDREWS);
+        w.setOnDemandRN();
+        REQUIRE( w.nRN() == 1000 );
+
+        UniformRNG rngMC(13);
+        for(int i=0; i<100; ++i)
+        {
+            const double A = w.A();
+            const std::string s = w.serialize();
+            w.change(rngMC);
+            w.undoChange();
+            REQUIRE( w.A() == A );
+            REQUIRE( w.serialize() == s );
+            w.change(rngMC);
+        }
+
+        // after a rejected change the same index gets a new proposal
+        for(int i=0; i<100; ++i)
+        {
+            UniformRNG rngSame(rngMC);
+            w.change(rngMC);
+            const std::string rejected = w.serialize();
+            w.undoChange();
+            w.change(rngSame);
+            REQUIRE( w.serialize() != rejected );
+        }
+    }
+
+    SECTION( "Gaussian Walk with random numbers on demand" ) {
+        GaussWalker w(2, 1000, rngReal, CH_ANDREWS);
+        w.setOnDemandRN();
+        REQUIRE( w.nRN() == 2000 );
+
+        UniformRNG rngMC(13);
+        for(int i=0; i<100; ++i)
+        {
+            const double A = w.A();
+            const std::string s = w.serialize();
+            w.change(rngMC);
+            w.undoChange();
+            REQUIRE( w.A() == A );
+            REQUIRE( w.serialize() == s );
+            w.change(rngMC);
+        }
+
+        const std::string s = w.serialize();
+        w.reconstruct();
+        REQUIRE( w.serialize() != s );
+    }
+
+    SECTION( "LERW change and undo" ) {
+        // replaying from a checkpoint is the same as erasing from scratch
+        LoopErasedWalker w(2, 200, rngReal, CH_SEGMENT_TREE);
+        checkChangeUndo(w, 10);
+    }
+
+    SECTION( "TSAW change and undo" ) {
+        // growing the rest of the walk is the same as growing all of it
+        TrueSelfAvoidingWalker w(2, 300, rngReal, CH_ANDREWS);
+        w.setP1(0.5);
+        checkChangeUndo(w, 10);
+    }
+
+    SECTION( "Reset change and undo" ) {
+        // only the excursion of the change is moved
+        ResetWalker w(2, 300, rngReal, CH_ANDREWS);
+        w.setP1(0.2);
+        checkChangeUndo(w, 1);
+    }
+
+    SECTION( "Returning change and undo" ) {
+        // only the points between the changed steps are moved
+        ReturningLatticeWalker w(2, 300, rngReal, CH_SEGMENT_TREE);
+        checkChangeUndo<ReturningLatticeWalker>(w, 1, [](const ReturningLatticeWalker &w){
+            REQUIRE( w.points().back() == w.points().front() );
+        });
+    }
+
+    SECTION( "Escape change and undo" ) {
+        // only the tail after the change is regrown, in d=2 with the
+        // partially updated segment tree hull
+        for(int d : {2, 3})
+        {
+            EscapeWalker w(d, 300, rngReal, d == 2 ? CH_SEGMENT_TREE : CH_NOP);
+            checkChangeUndo(w, 10);
+        }
+    }
+
+    SECTION( "Scent walkers moved in parallel" ) {
+        // the decomposition is forced, with OpenMP it runs on two threads
+        #ifdef _OPENMP
+        const int threads = omp_get_max_threads();
+        omp_set_num_threads(2);
+        #endif
+        for(auto start : {AS_RANDOM, AS_TRIANGULAR})
+            for(bool amnesia : {false, true})
+            {
+                ScentWalker serial(2, 200, 80, 60, 20, start, UniformRNG(3), CH_ANDREWS, amnesia);
+                ScentWalker parallel(2, 200, 80, 60, 20, start, UniformRNG(3), CH_ANDREWS, amnesia);
+                serial.minParallelWalkers = std::numeric_limits<int>::max();
+                parallel.minParallelWalkers = 0;
+
+                UniformRNG rngA(13), rngB(13);
+                for(int i=0; i<5; ++i)
+                {
+                    if(amnesia)
+                    {
+                        serial.updateSteps();
+                        parallel.updateSteps();
+                    }
+                    else
+                    {
+                        serial.change(rngA);
+                        parallel.change(rngB);
+                    }
+                    REQUIRE( parallel.steps() == serial.steps() );
+                    for(int j=0; j<serial.numWalker; ++j)
+                        REQUIRE( parallel.interactions(j) == serial.interactions(j) );
+                }
+            }
+        #ifdef _OPENMP
+        omp_set_num_threads(threads);
+        #endif
     }
 
     SECTION( "Closed Walk" ) {
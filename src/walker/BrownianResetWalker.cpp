@@ -18,8 +18,7 @@ BrownianResetWalker::BrownianResetWalker(int d, int numSteps, const UniformRNG &
 void BrownianResetWalker::reconstruct()
 {
     // write new random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
     for(int i=0; i<numSteps; ++i)
         random_numbers[i*(d+1)] = rng();
     init();
@@ -82,13 +81,10 @@ void BrownianResetWalker::change(UniformRNG &rng, bool update)
 
     m_steps[idx] = genStep(random_numbers.begin() + rnidx + 1);
     m_steps[idx] *= sqrt(delta_t);
-    updatePoints(idx+1);
+    updatePointsLazy(idx+1);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 /// Undoes the last change.
@@ -100,8 +96,8 @@ void BrownianResetWalker::undoChange()
 
     m_steps[undo_index] = genStep(undo_values.begin() + 1);
     m_steps[undo_index] *= sqrt(delta_t);
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
 
 void BrownianResetWalker::setP1(double p1)
@@ -23,8 +23,7 @@ void CorrelatedWalker::reconstruct()
     // we need d random numbers per step, for each angle difference one and a distance
     // we generate d per step and overwrite unnecessary ones afterwards
     // TODO: replace Gaussian by wrapped normal
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
     // and for the distance a uniformly distributed one
     for(int i=0; i<numSteps; ++i)
         random_numbers[i*d] = rng.uniform();
@@ -128,11 +127,9 @@ void CorrelatedWalker::change(UniformRNG &rng, bool update)
     m_steps[idx] = genStep(random_numbers.begin() + rnidx);
     updatePoints(idx+1);
 
+    m_convex_hull.beginTrial();
     if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
         updateHull();
-    }
 }
 
 void CorrelatedWalker::undoChange()
@@ -143,5 +140,5 @@ void CorrelatedWalker::undoChange()
 
     m_steps[undo_index] = genStep(undo_values.begin());
     updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    m_convex_hull.rollback();
 }
@@ -7,6 +7,8 @@ EscapeWalker::EscapeWalker(int d, int numSteps, const UniformRNG &rng_in, hull_a
     undoStep = Step<int>(d);
     winding_angle = std::vector<int>(numSteps + 1, 0);
     m_steps = std::vector<Step<int>>(numSteps);
+    box_min = std::vector<Step<int>>(numSteps + 1, Step<int>(d));
+    box_max = std::vector<Step<int>>(numSteps + 1, Step<int>(d));
 
     if(!amnesia)
         random_numbers = rng.vector(numSteps);
@@ -19,7 +21,7 @@ void EscapeWalker::reconstruct()
     if(!amnesia)
     {
         // write new random numers into our state
-        std::generate(random_numbers.begin(), random_numbers.end(), std::ref(rng));
+        rng.fill(random_numbers);
     }
     init();
 }
@@ -195,52 +197,41 @@ bool EscapeWalker::escapable(const Step<int> &next, const int index)
     // fast filter: we can only get trapped, if we have 4 nearest neigbors
     // blocking an exit, if we have less, everything is safe.
     int ctr = 0;
-    for(const auto &n : next.neighbors())
-        ctr += occupied.count(n);
+    Step<int> n = next;
+    for(int axis=0; axis<d; ++axis)
+        for(int direction=1; direction>=-1; direction-=2)
+        {
+            n[axis] += direction;
+            ctr += occupied.count(n);
+            n[axis] -= direction;
+        }
     if(ctr < 4)
         return true;
 
     // otherwise do a brute force search, if it is possible that
     // we get trapped
 
-    // get a bounding box, such that we dont explore the whole possible lattice
-    std::vector<int> min_b(d, 0);
-    std::vector<int> max_b(d, 0);
-
-    // get the bounding box from all points up to the current
-    for(auto it = begin(m_points); it < begin(m_points) + index; ++it)
-    {
-        const auto &i = *it;
-        for(int axis=0; axis<d; ++axis)
-        {
-            if(min_b[axis] > i[axis])
-                min_b[axis] = i[axis];
-            if(max_b[axis] < i[axis])
-                max_b[axis] = i[axis];
-        }
-    }
-    for(int axis=0; axis<d; ++axis)
-    {
-        min_b[axis] -= 1;
-        max_b[axis] += 1;
-    }
+    // the bounding box of all points up to the current one, enlarged
+    // by one, such that we dont explore the whole possible lattice
+    const Step<int> &min_b = box_min[index];
+    const Step<int> &max_b = box_max[index];
 
     // next find the corner of the bounding box
     // nearest to the head position such that we need only a
     // few steps to reach infinity
-    std::vector<int> point(d, 0);
-    Step<int> target;
+    Step<int> point(d);
+    Step<int> target(d);
     int dist = 2000000000;
-    for(int i=0; i<std::pow(2, d); ++i)
+    for(int i=0; i<(1 << d); ++i)
     {
         for(int j=0; j<d; ++j)
         {
-            point[j] = (i & (1 << j)) ? min_b[j] : max_b[j];
+            point[j] = (i & (1 << j)) ? min_b[j] - 1 : max_b[j] + 1;
         }
 
-        if(next.dist(Step<int>(point)) < dist)
+        if(next.dist(point) < dist)
         {
-            target = Step<int>(point);
+            target = point;
             dist = next.dist(target);
         }
     }
@@ -248,13 +239,29 @@ bool EscapeWalker::escapable(const Step<int> &next, const int index)
     return g.bestfs(next, target, occupied);
 }
 
-void EscapeWalker::updateStepsFrom(int start)
+/// box_min[i+1] and box_max[i+1] from the box before and point i
+void EscapeWalker::updateBox(int i)
 {
-    occupied.clear();
-    occupied.emplace(Step<int>(d), 0);
-    for(int i=0; i<=start; ++i)
-        occupied.emplace(m_points[i], i);
+    for(int axis=0; axis<d; ++axis)
+    {
+        box_min[i+1][axis] = std::min(box_min[i][axis], m_points[i][axis]);
+        box_max[i+1][axis] = std::max(box_max[i][axis], m_points[i][axis]);
+    }
+}
 
+/// removes the points after start from the occupied sites
+void EscapeWalker::eraseTail(int start)
+{
+    for(int i=start+1; i<=numSteps; ++i)
+        occupied.erase(m_points[i]);
+}
+
+/** Regrows the walk after point start.
+ *
+ * The occupied sites need to contain exactly the points up to start.
+ */
+void EscapeWalker::updateStepsFrom(int start)
+{
     Step<int> head = m_points[start];
     Step<int> next(d);
     Step<int> prev(d);
@@ -296,6 +303,7 @@ void EscapeWalker::updateStepsFrom(int start)
         }
         else // best first search for everything else
         {
+            updateBox(i);
             for(const auto &n : head.neighbors())
                 if(!occupied.count(n) && escapable(n, i))
                     candidates.emplace_back(n-head);
@@ -311,7 +319,7 @@ void EscapeWalker::updateStepsFrom(int start)
 
         m_steps[i] = next;
         m_points[i+1] = head;
-        occupied.emplace(head, i+1);
+        occupied.insert(head, i+1);
     }
 }
 
@@ -322,6 +330,8 @@ void EscapeWalker::updatePoints(int /*start*/)
 
 void EscapeWalker::updateSteps()
 {
+    occupied.clear();
+    occupied.insert(m_points[0], 0);
     updateStepsFrom(0);
 }
 
@@ -334,19 +344,35 @@ void EscapeWalker::change(UniformRNG &rng, bool update)
 
     newStep.fillFromRN(random_numbers[idx]);
 
+    undo_steps.assign(m_steps.begin() + idx, m_steps.end());
+    undo_points.assign(m_points.begin() + idx + 1, m_points.end());
+    if(d == 2)
+        undo_winding_angle.assign(winding_angle.begin() + idx + 1, winding_angle.end());
+
+    eraseTail(idx);
     updateStepsFrom(idx);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, numSteps-1, update);
 }
 
 void EscapeWalker::undoChange()
 {
     random_numbers[undo_index] = undo_value;
 
-    updateStepsFrom(undo_index);
-    m_convex_hull = m_old_convex_hull;
+    // the old tail is restored instead of regrown
+    eraseTail(undo_index);
+    std::copy(undo_steps.begin(), undo_steps.end(), m_steps.begin() + undo_index);
+    std::copy(undo_points.begin(), undo_points.end(), m_points.begin() + undo_index + 1);
+    if(d == 2)
+        std::copy(undo_winding_angle.begin(), undo_winding_angle.end(), winding_angle.begin() + undo_index + 1);
+
+    for(int i=undo_index+1; i<=numSteps; ++i)
+    {
+        occupied.insert(m_points[i], i);
+        if(d > 2)
+            updateBox(i-1);
+    }
+
+    m_convex_hull.rollback();
 }
@@ -1,12 +1,11 @@
 #ifndef ESCAPEWALKER_H
 #define ESCAPEWALKER_H
 
-#include <unordered_map>
-#include <unordered_set>
 #include <bitset>
 #include <array>
 
 #include "../Logging.hpp"
+#include "../LatticeMap.hpp"
 #include "../Hypercube.hpp"
 #include "SpecWalker.hpp"
 
@@ -27,6 +26,10 @@
  * The exponent nu is expected to be 4/7.
  * 10.1103/PhysRevLett.59.539
  *
+ * A change only regrows the walk after the changed step. The occupied
+ * sites of the old tail are removed from the map instead of rebuilding
+ * it, and the old tail is saved, such that undoChange() just restores it.
+ *
  * \image html SKSAW.svg "example of a smart kinetic random walk"
  */
 class EscapeWalker final : public SpecWalker<int>
@@ -45,11 +48,22 @@ class EscapeWalker final : public SpecWalker<int>
     protected:
         Step<int> newStep;
         Step<int> undoStep;
-        std::unordered_map<Step<int>, int> occupied;
+        LatticeMap<int> occupied;
 
         std::vector<int> winding_angle;
 
         void updateStepsFrom(int start);
+        void eraseTail(int start);
+
+        // bounding box of the points before i, box_min[i] and box_max[i]
+        std::vector<Step<int>> box_min;
+        std::vector<Step<int>> box_max;
+        void updateBox(int i);
+
+        // tail of the walk before the last change
+        std::vector<Step<int>> undo_steps;
+        std::vector<Step<int>> undo_points;
+        std::vector<int> undo_winding_angle;
 
         bool escapable(const Step<int> &next, const int index);
         std::bitset<3> safeOptions(const Step<int> &current, const Step<int> &direction);
@@ -16,8 +16,7 @@ GaussResetWalker::GaussResetWalker(int d, int numSteps, const UniformRNG &rng_in
 void GaussResetWalker::reconstruct()
 {
     // write new random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
     for(int i=0; i<numSteps; ++i)
         random_numbers[i*(d+1)] = rng();
     init();
@@ -74,13 +73,10 @@ void GaussResetWalker::change(UniformRNG &rng, bool update)
     }
 
     m_steps[idx] = genStep(random_numbers.begin() + rnidx + 1);
-    updatePoints(idx+1);
+    updatePointsLazy(idx+1);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 /// Undoes the last change.
@@ -90,8 +86,8 @@ void GaussResetWalker::undoChange()
         random_numbers[undo_index*(d+1) + i] = undo_values[i];
 
     m_steps[undo_index] = genStep(undo_values.begin() + 1);
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
 
 void GaussResetWalker::setP1(double p1)
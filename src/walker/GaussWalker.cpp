@@ -8,12 +8,32 @@ GaussWalker::GaussWalker(int d, int numSteps, const UniformRNG &rng_in, hull_alg
     init();
 }
 
+/** Calculate the displacements when needed instead of storing them.
+ *
+ * Draws a new, independent walk. A change renews the d displacements
+ * of the step from its counter based stream instead of drawing them
+ * from the Monte Carlo generator.
+ */
+void GaussWalker::setOnDemandRN()
+{
+    random_on_demand = rng.onDemand(numSteps, d, true);
+    on_demand = true;
+    std::vector<double>().swap(random_numbers);
+    init();
+}
+
 /// Get new random numbers and reconstruct the walk
 void GaussWalker::reconstruct()
 {
+    if(on_demand)
+    {
+        random_on_demand.regenerate();
+        init();
+        return;
+    }
+
     // write new gaussian random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
     init();
 }
 
@@ -31,11 +51,23 @@ Step<double> GaussWalker::genStep(std::vector<double>::iterator first) const
     return Step<double>(std::vector<double>(first, first+d));
 }
 
+/// Step from the d on demand displacements of entry i
+Step<double> GaussWalker::genStepOnDemand(int i) const
+{
+    std::vector<double> x(d);
+    random_on_demand.fill(i, x.data());
+    return Step<double>(x);
+}
+
 void GaussWalker::updateSteps()
 {
     m_steps.resize(numSteps);
-    for(int i=0; i<numSteps; ++i)
-        m_steps[i] = genStep(random_numbers.begin() + i*d);
+    if(on_demand)
+        for(int i=0; i<numSteps; ++i)
+            m_steps[i] = genStepOnDemand(i);
+    else
+        for(int i=0; i<numSteps; ++i)
+            m_steps[i] = genStep(random_numbers.begin() + i*d);
 }
 
 void GaussWalker::change(UniformRNG &rng, bool update)
@@ -43,32 +75,45 @@ void GaussWalker::change(UniformRNG &rng, bool update)
     // We need d random numbers per step to determine the d directions
     steps(); // steps need to be initialized
     int idx = rng() * numSteps;
-    int rnidx = idx * d;
     undo_index = idx;
-    undo_values = std::vector<double>(random_numbers.begin() + rnidx,
-                                      random_numbers.begin() + rnidx + d);
-    for(int i=0; i<d; ++i)
-        random_numbers[rnidx+i] = rng.gaussian();
-
-    m_steps[idx] = genStep(random_numbers.begin() + rnidx);
-    updatePoints(idx+1);
-
-    if(update)
+    if(on_demand)
     {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
+        random_on_demand.renew(idx);
+        m_steps[idx] = genStepOnDemand(idx);
     }
+    else
+    {
+        int rnidx = idx * d;
+        undo_values = std::vector<double>(random_numbers.begin() + rnidx,
+                                          random_numbers.begin() + rnidx + d);
+        for(int i=0; i<d; ++i)
+            random_numbers[rnidx+i] = rng.gaussian();
+
+        m_steps[idx] = genStep(random_numbers.begin() + rnidx);
+    }
+    updatePointsLazy(idx+1);
+
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 void GaussWalker::undoChange()
 {
-    int t = 0;
-    for(const auto i : undo_values)
-        random_numbers[undo_index*d + t++] = i;
+    if(on_demand)
+    {
+        random_on_demand.restore(undo_index);
+        m_steps[undo_index] = genStepOnDemand(undo_index);
+    }
+    else
+    {
+        int t = 0;
+        for(const auto i : undo_values)
+            random_numbers[undo_index*d + t++] = i;
 
-    m_steps[undo_index] = genStep(undo_values.begin());
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+        m_steps[undo_index] = genStep(undo_values.begin());
+    }
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
 
 /** Set the random numbers such that we get an half circle shape.
@@ -81,6 +126,13 @@ void GaussWalker::degenerateMaxVolume()
 {
     // FIXME: works only for d=2
     // I am not sure how the greatest volume in d=3 is constructed
+    if(on_demand)
+    {
+        LOG(LOG_WARNING) << "the degenerate walk needs stored random numbers, --onDemandRN is ignored";
+        on_demand = false;
+        random_numbers.resize(d * numSteps);
+    }
+
     double r = 2;
     for(int i=0; i<numSteps; ++i)
     {
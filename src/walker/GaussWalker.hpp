@@ -7,6 +7,8 @@
 /** A walk with displacements drawn from a gaussian distribution (model for brownian motion).
  *
  * Draw the x, y, z, ... displacements from Gaussian distributions at each step.
+ * With setOnDemandRN() the displacements are not stored, only the four
+ * byte ids of OnDemandRN instead of 8*d bytes per step.
  *
  * \image html GRW.svg "example of a gaussian random walk"
  */
@@ -15,6 +17,8 @@ class GaussWalker final : public SpecWalker<double>
     public:
         GaussWalker(int d, int numSteps, const UniformRNG &rng, hull_algorithm_t hull_algo, bool amnesia=false);
 
+        void setOnDemandRN() final;
+
         void reconstruct() final;
 
         void updateSteps() final;
@@ -29,6 +33,7 @@ class GaussWalker final : public SpecWalker<double>
 
     protected:
         Step<double> genStep(std::vector<double>::iterator first) const;
+        Step<double> genStepOnDemand(int i) const;
 
         std::vector<double> undo_values;
 };
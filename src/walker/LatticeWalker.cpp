@@ -8,45 +8,80 @@ LatticeWalker::LatticeWalker(int d, int numSteps, const UniformRNG &rng_in, hull
     init();
 }
 
+/** Calculate the random numbers when needed instead of storing them.
+ *
+ * Draws a new, independent walk. A change renews the random number
+ * from its counter based stream instead of drawing it from the
+ * Monte Carlo generator.
+ */
+void LatticeWalker::setOnDemandRN()
+{
+    random_on_demand = rng.onDemand(numSteps);
+    on_demand = true;
+    std::vector<double>().swap(random_numbers);
+    init();
+}
+
 void LatticeWalker::updateSteps()
 {
     m_steps.clear();
     m_steps.reserve(numSteps);
-    for(int i=0; i<numSteps; ++i)
-        m_steps.emplace_back(d, random_numbers[i]);
+    if(on_demand)
+        for(int i=0; i<numSteps; ++i)
+            m_steps.emplace_back(d, random_on_demand[i]);
+    else
+        for(int i=0; i<numSteps; ++i)
+            m_steps.emplace_back(d, random_numbers[i]);
 }
 
 void LatticeWalker::change(UniformRNG &rng, bool update)
 {
+    forgetChange();
     int idx = rng() * nRN();
     undo_index = idx;
-    undo_value = random_numbers[idx];
-    random_numbers[idx] = rng();
-
-    newStep.fillFromRN(random_numbers[idx]);
+    if(on_demand)
+    {
+        random_on_demand.renew(idx);
+        newStep.fillFromRN(random_on_demand[idx]);
+    }
+    else
+    {
+        undo_value = random_numbers[idx];
+        random_numbers[idx] = rng();
+        newStep.fillFromRN(random_numbers[idx]);
+    }
     // test if something changes
     if(newStep == m_steps[idx])
+    {
+        changedNothing();
         return;
+    }
 
     m_steps[idx].swap(newStep);
-    updatePoints(idx+1);
+    updatePointsLazy(idx+1);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 void LatticeWalker::undoChange()
 {
-    random_numbers[undo_index] = undo_value;
-    newStep.fillFromRN(undo_value);
+    forgetChange();
+    if(on_demand)
+    {
+        random_on_demand.restore(undo_index);
+        newStep.fillFromRN(random_on_demand[undo_index]);
+    }
+    else
+    {
+        random_numbers[undo_index] = undo_value;
+        newStep.fillFromRN(undo_value);
+    }
     // test if something changes
     if(newStep == m_steps[undo_index])
         return;
 
     m_steps[undo_index].swap(newStep);
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
@@ -8,6 +8,8 @@
  *
  * Standard lattice random walk, with immediate reversals.
  * Th lattice constant is unity.
+ * With setOnDemandRN() the random numbers are not stored, only the
+ * four byte ids of OnDemandRN instead of eight bytes per step.
  *
  * \image html LRW.svg "example of a random walk on a square lattice"
  */
@@ -16,6 +18,8 @@ class LatticeWalker final : public SpecWalker<int>
     public:
         LatticeWalker(int d, int numSteps, const UniformRNG &rng, hull_algorithm_t hull_algo, bool amnesia=false);
 
+        void setOnDemandRN() final;
+
         void updateSteps() final;
 
         void change(UniformRNG &rng, bool update=true) final;
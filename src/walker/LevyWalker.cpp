@@ -15,8 +15,7 @@ LevyWalker::LevyWalker(int d, int numSteps, const UniformRNG &rng_in, hull_algor
 void LevyWalker::reconstruct()
 {
     // write new gaussian random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng(); });
+    rng.fill(random_numbers);
     for(int i=0; i<numSteps; ++i)
         random_numbers[i*d] = std::abs(rng.cauchy(1.));
     init();
@@ -81,13 +80,10 @@ void LevyWalker::change(UniformRNG &rng, bool update)
         random_numbers[rnidx + i] = rng();
 
     m_steps[idx] = genStep(random_numbers.begin() + rnidx);
-    updatePoints(idx+1);
+    updatePointsLazy(idx+1);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 void LevyWalker::undoChange()
@@ -97,6 +93,6 @@ void LevyWalker::undoChange()
         random_numbers[undo_index * (d-1) + t++] = i;
 
     m_steps[undo_index] = genStep(undo_values.begin());
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
@@ -22,7 +22,7 @@ void LoopErasedWalker::reconstruct()
             random_numbers.resize(expected_space_needed); // resize will not free memory
 
         // write new random numers into our state
-        std::generate(random_numbers.begin(), random_numbers.end(), std::ref(rng));
+        rng.fill(random_numbers);
     }
     init();
 }
@@ -30,27 +30,43 @@ void LoopErasedWalker::reconstruct()
 void LoopErasedWalker::updateSteps()
 {
     // add steps
-    // save their coordinates in a hashmap with their index
-    // if a new coordinate is already in the hashmap, erase the loop
-    // by setting the current position back to the index obtained from the
-    // hashmap. Also clear the hashmap from all entries with a greater index
-    // by iterating over the vector of steps taken, starting at index+1
+    // save their coordinates in a hashmap with their node
+    // if a new coordinate is already part of the path, erase the loop
+    // by setting the current position back to this node
     // then continue
 
-    int N = random_numbers.size();
-    std::unordered_map<Step<int>, int> occupied_tiles;
-    // at most as many steps as random numbers, i.e. no loop erasure
-    std::vector<Step<int>> ret(numSteps);
+    nodes.clear();
+    nodes.push_back({Step<int>(d), -1, 0, -1});
+    chain.assign(1, 0);
+    latestAtSite.clear();
+    latestAtSite[nodes[0].pos] = 0;
+    checkpoints.clear();
 
-    // p will keep track where the head is
-    Step<int> p(d);
-    Step<int> s(d);
-    occupied_tiles.emplace(p, 0);
+    erase(0);
 
-    int i=0;
-    int index=0;
-    while(index < numSteps)
+    m_steps.resize(numSteps);
+    updateStepsFrom(0);
+}
+
+/** Continues the loop erasure of the current path with raw step i.
+ *
+ * Until the path consists of numSteps steps.
+ */
+void LoopErasedWalker::erase(int i)
+{
+    int N = random_numbers.size();
+    int h = chain.size() - 1;
+    Step<int> s(d);
+    while(h < numSteps)
     {
+        if(i % checkpointInterval == 0)
+        {
+            const int c = i / checkpointInterval;
+            if(c >= (int) checkpoints.size())
+                checkpoints.resize(c+1);
+            checkpoints[c] = {chain[h], (int) nodes.size()};
+        }
+
         if(!amnesia)
         {
             // generate more random numbers if necessary
@@ -68,46 +84,65 @@ void LoopErasedWalker::updateSteps()
         {
             s.fillFromRN(rng());
         }
-        p += s;
+        const Step<int> p = nodes[chain[h]].pos + s;
 
-        // if already occupied, erase loop
-        auto it = occupied_tiles.find(p);
-        if(it != occupied_tiles.end())
+        // nodes which were erased are still in the map, but not in the chain
+        int *latest = latestAtSite.find(p);
+        const int k = latest && *latest >= 0 ? nodes[*latest].depth : -1;
+        if(k >= 0 && k <= h && chain[k] == *latest)
         {
-            int tmp = it->second;
-            // zero is a special case
-            if(tmp == 0)
-            {
-                occupied_tiles.clear();
-                p.setZero();
-                occupied_tiles.emplace(p, 0);
-                index = -1;
-            }
-            else
-            {
-                for(int j=tmp+1; j<index; ++j)
-                {
-                    // loop -> p is the same
-                    p += ret[j];
-                    occupied_tiles.erase(p);
-                }
-                p += s;
-                index = tmp;
-            }
+            // if already occupied, erase loop
+            // returning to the first point erases everything
+            // (historically the same index as the origin)
+            h = k <= 1 ? 0 : k;
+            chain.resize(h+1);
         }
         else
         {
-            ret[index] = s;
-            occupied_tiles.emplace(p, index);
+            const int id = nodes.size();
+            nodes.push_back({p, chain[h], h+1, latest ? *latest : -1});
+            if(latest)
+                *latest = id;
+            else
+                latestAtSite[p] = id;
+            chain.push_back(id);
+            ++h;
         }
 
-        ++index;
         ++i;
     }
     random_numbers_used = i;
     LOG(LOG_TOO_MUCH) << "Random numbers used: " << random_numbers_used;
+}
+
+/// Removes all nodes from numNodes on and makes top the end of the path.
+void LoopErasedWalker::rewind(int numNodes, int top)
+{
+    for(int id=nodes.size()-1; id>=numNodes; --id)
+        *latestAtSite.find(nodes[id].pos) = nodes[id].prevAtSite;
+    nodes.resize(numNodes);
+
+    // only the part of the path, which differs from the chain of top
+    int k = nodes[top].depth;
+    chain.resize(k+1, -1);
+    for(int v=top; v >= 0 && chain[k] != v; v=nodes[v].parent, --k)
+        chain[k] = v;
+}
 
-    m_steps = ret;
+/// Largest k, such that the path up to point k is the chain of node top.
+int LoopErasedWalker::commonDepth(int top) const
+{
+    int k = nodes[top].depth;
+    for(int v=top; v > 0 && chain[k] != v; v=nodes[v].parent)
+        --k;
+    return k;
+}
+
+/// Sets the steps from step first on to the current path.
+void LoopErasedWalker::updateStepsFrom(int first)
+{
+    for(int k=first; k<numSteps; ++k)
+        m_steps[k] = nodes[chain[k+1]].pos - nodes[chain[k]].pos;
 }
 
 int LoopErasedWalker::nRN() const
@@ -115,9 +150,16 @@ int LoopErasedWalker::nRN() const
     return random_numbers_used;
 }
 
+/** Changes one random number.
+ *
+ * The path before the raw step of this random number is not affected.
+ * The erasure is replayed from the last checkpoint before it, the
+ * replaced nodes and checkpoints and the path after the depth of the
+ * checkpoint are saved for undoChange().
+ */
 void LoopErasedWalker::change(UniformRNG &rng, bool update)
 {
-    // I should do this in a far more clever way
+    forgetChange();
     int idx = rng() * nRN();
     undo_index = idx;
     undo_value = random_numbers[idx];
@@ -127,28 +169,84 @@ void LoopErasedWalker::change(UniformRNG &rng, bool update)
     // test if something changes
     undoStep.fillFromRN(undo_value);
     if(newStep == undoStep)
+    {
+        changedNothing();
         return;
+    }
 
-    updateSteps();
-    updatePoints();
+    const int c = idx / checkpointInterval;
+    const Checkpoint start = checkpoints[c];
+    undo_checkpoint = c;
+    undo_random_numbers_used = random_numbers_used;
+    undo_nodes.assign(nodes.begin() + start.numNodes, nodes.end());
+    undo_checkpoints.assign(checkpoints.begin() + c, checkpoints.end());
 
-    if(update)
+    // the path is the chain of the checkpoint up to undo_depth,
+    // only the rest needs to be saved
+    undo_depth = commonDepth(start.top);
+    undo_top = chain[undo_depth];
+    undo_chain.assign(chain.begin() + undo_depth + 1, chain.end());
+
+    rewind(start.numNodes, start.top);
+    checkpoints.resize(c+1);
+    erase(c * checkpointInterval);
+
+    // the replay may have erased loops below undo_depth, then the
+    // old nodes in between are the ancestors of undo_top
+    const int k = commonDepth(undo_top);
+    if(k < undo_depth)
     {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
+        undo_chain.insert(undo_chain.begin(), undo_depth - k, -1);
+        int v = undo_top;
+        for(int j=undo_depth; j>k; --j, v=nodes[v].parent)
+            undo_chain[j - k - 1] = v;
+        undo_depth = k;
+        undo_top = chain[k];
     }
+
+    // the path is unchanged up to the first point at a different site,
+    // replaced nodes are only in undo_nodes
+    undo_first = undo_depth + 1;
+    while(undo_first <= numSteps)
+    {
+        const int old = undo_chain[undo_first - undo_depth - 1];
+        const Step<int> &oldPos = old < start.numNodes ? nodes[old].pos : undo_nodes[old - start.numNodes].pos;
+        if(!(nodes[chain[undo_first]].pos == oldPos))
+            break;
+        ++undo_first;
+    }
+    updateStepsFrom(undo_first - 1);
+    updatePoints(undo_first);
+
+    m_convex_hull.beginTrial();
+    if(update)
+        updateHull();
 }
 
 void LoopErasedWalker::undoChange()
 {
+    forgetChange();
     random_numbers[undo_index] = undo_value;
     // test if something changed
     if(newStep == undoStep)
         return;
 
-    updateSteps();
-    updatePoints();
-    m_convex_hull = m_old_convex_hull;
+    // restore the nodes, checkpoints and the saved part of the old path
+    rewind(checkpoints[undo_checkpoint].numNodes, undo_top);
+    for(const auto &node : undo_nodes)
+    {
+        const int id = nodes.size();
+        nodes.push_back(node);
+        latestAtSite[node.pos] = id;
+    }
+    checkpoints.resize(undo_checkpoint);
+    checkpoints.insert(checkpoints.end(), undo_checkpoints.begin(), undo_checkpoints.end());
+    chain.insert(chain.end(), undo_chain.begin(), undo_chain.end());
+    random_numbers_used = undo_random_numbers_used;
+
+    updateStepsFrom(undo_first - 1);
+    updatePoints(undo_first);
+    m_convex_hull.rollback();
 }
 
 void LoopErasedWalker::svgOfErasedLoops(std::string filename)
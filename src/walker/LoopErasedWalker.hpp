@@ -1,9 +1,8 @@
 #ifndef LOOPERASEDWALKER_H
 #define LOOPERASEDWALKER_H
 
-#include <unordered_map>
-
 #include "../Logging.hpp"
+#include "../LatticeMap.hpp"
 #include "SpecWalker.hpp"
 
 /** Loop Erased Random Walk
@@ -14,6 +13,13 @@
  * doi: 10.1.1.56.2276
  * [wiki](https://en.wikipedia.org/wiki/Loop-erased_random_walk)
  *
+ * The erasure keeps every point ever added to the loop erased path as
+ * a node of a tree, such that the path after any number of raw steps
+ * is the chain from a node to the root. Every checkpointInterval raw
+ * steps the current node is saved, a change of a random number only
+ * replays the raw steps from the checkpoint before it and undoChange()
+ * restores the replaced nodes instead of recomputing them.
+ *
  * \image html LERW.svg "example of a loop erased random walk"
  */
 class LoopErasedWalker final : public SpecWalker<int>
@@ -36,6 +42,43 @@ class LoopErasedWalker final : public SpecWalker<int>
         mutable int random_numbers_used;
         Step<int> newStep;
         Step<int> undoStep;
+
+        static const int checkpointInterval = 16;
+
+        /// a point which was added to the loop erased path
+        struct Node
+        {
+            Step<int> pos;
+            int parent;
+            int depth;      ///< index of the point in the path
+            int prevAtSite; ///< node which was added before at the same site, or -1
+        };
+
+        /// state of the erasure before raw step checkpointInterval*i
+        struct Checkpoint
+        {
+            int top;
+            int numNodes;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<int> chain;                 ///< nodes of the current path
+        LatticeMap<int> latestAtSite;           ///< latest node at a site
+        std::vector<Checkpoint> checkpoints;
+
+        void erase(int i);
+        void rewind(int numNodes, int top);
+        int commonDepth(int top) const;
+        void updateStepsFrom(int first);
+
+        std::vector<Node> undo_nodes;
+        std::vector<Checkpoint> undo_checkpoints;
+        std::vector<int> undo_chain;    ///< old path after point undo_depth
+        int undo_depth;
+        int undo_top;                   ///< node at undo_depth, shared by the old and new path
+        int undo_checkpoint;
+        int undo_random_numbers_used;
+        int undo_first;
 };
 
 #endif
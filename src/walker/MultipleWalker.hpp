@@ -26,6 +26,11 @@
  *      -> no code needs to be touched
  *      -> no performance regressions are possible
  *
+ * The joint hull is built from the hulls of the single walkers, which
+ * they maintain anyway. After a change of one walker only its hull is
+ * merged again with the cached merged hulls of the others, see
+ * ConvexHull::runUnion().
+ *
  * \tparam T class of the Walk type that should be wrapped
  *
  * \image html multi.svg "two random walks and their joint convex hull"
@@ -48,6 +53,7 @@ class MultipleWalker : public Walker
         virtual void setP1(double p1);
         virtual void setP2(double p2);
         virtual void setP3(double p3);
+        virtual void setOnDemandRN();
 
         // convenience functions
         double A() const final;
@@ -101,20 +107,27 @@ class MultipleWalker : public Walker
         std::vector<T> m_walker;
 
         ConvexHull<decltype(T::T_type())> m_convex_hull;
-        ConvexHull<decltype(T::T_type())> m_old_convex_hull;
         int undo_walker_idx;
+
+        std::vector<const std::vector<Step<decltype(T::T_type())>>*> m_walker_hulls;
+        int changed_walker;         ///< only walker changed since the last updateHull() or -1
+        bool hull_updated;          ///< whether the joint hull is up to date
+        bool undo_hull_updated;
 };
 
 template <class T>
 MultipleWalker<T>::MultipleWalker(int d, int numSteps, int numWalker, const UniformRNG &rng_in, hull_algorithm_t hull_algo, bool amnesia)
     : Walker(d, numSteps, rng_in, hull_algo, amnesia),
-      numWalker(numWalker)
+      numWalker(numWalker),
+      m_convex_hull(hull_algo),
+      changed_walker(-1),
+      hull_updated(false)
 {
     m_walker.reserve(numWalker);
     for(int i=0; i<numWalker; ++i)
     {
-        auto rng_privat = UniformRNG(rng() * 2000000000);
-        m_walker.emplace_back(d, numSteps, rng_privat, hull_algo, amnesia);
+        // walker 0 is the stream of this walker itself
+        m_walker.emplace_back(d, numSteps, rng.substream(i+1), hull_algo, amnesia);
     }
     updateHull();
 }
@@ -144,6 +157,9 @@ void MultipleWalker<T>::setHullAlgo(hull_algorithm_t a)
 {
     for(auto &w : m_walker)
         w.setHullAlgo(a);
+    m_convex_hull.setHullAlgo(a);
+    changed_walker = -1;
+    updateHull();
 }
 
 template <class T>
@@ -153,6 +169,13 @@ void MultipleWalker<T>::setP1(double p1)
         w.setP1(p1);
 }
 
+template <class T>
+void MultipleWalker<T>::setOnDemandRN()
+{
+    for(auto &w : m_walker)
+        w.setOnDemandRN();
+}
+
 template <class T>
 void MultipleWalker<T>::setP2(double p2)
 {
@@ -173,18 +196,23 @@ void MultipleWalker<T>::change(UniformRNG &rng, bool update)
     undo_walker_idx = floor(rng() * m_walker.size());
     m_walker[undo_walker_idx].change(rng, true);
 
+    undo_hull_updated = hull_updated;
+    changed_walker = hull_updated ? undo_walker_idx : -1;
+    hull_updated = false;
+
+    m_convex_hull.beginTrial();
     if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
         updateHull();
-    }
 }
 
 template <class T>
 void MultipleWalker<T>::undoChange()
 {
     m_walker[undo_walker_idx].undoChange();
-    m_convex_hull = m_old_convex_hull;
+    m_convex_hull.rollback();
+
+    hull_updated = undo_hull_updated;
+    changed_walker = -1;
 }
 
 template <class T>
@@ -192,6 +220,8 @@ void MultipleWalker<T>::updateSteps()
 {
     for(auto &w : m_walker)
         w.updateSteps();
+    hull_updated = false;
+    changed_walker = -1;
 }
 
 // We ignore start, since this parameter should only be used from inside
@@ -201,24 +231,21 @@ void MultipleWalker<T>::updatePoints(int /*start*/)
 {
     for(auto &w : m_walker)
         w.updatePoints();
+    hull_updated = false;
+    changed_walker = -1;
 }
 
 template <class T>
 void MultipleWalker<T>::updateHull()
 {
-    // FIXME: this will be copying way too much and needs to be
-    // optimized. Maybe with a new method of ConvexHull which takes
-    // multiple vectors?
-    // omg this seems not right
-    std::vector<Step<decltype(T::T_type())>> all_points;
-    all_points.reserve(numSteps*numWalker);
-
+    m_walker_hulls.clear();
     for(auto &w : m_walker)
-    {
-        auto &p = w.hullPoints();
-        all_points.insert(all_points.end(), p.begin(), p.end());
-    }
-    m_convex_hull.run(&all_points);
+        m_walker_hulls.push_back(&w.hullPoints());
+
+    // after reconstructions all hulls have to be merged again
+    m_convex_hull.runUnion(m_walker_hulls, hull_updated ? -1 : changed_walker);
+    changed_walker = -1;
+    hull_updated = true;
 
     LOG(LOG_TOO_MUCH) << "Updated";
     LOG(LOG_TOO_MUCH) << m_convex_hull.A() << " " << m_convex_hull.L();
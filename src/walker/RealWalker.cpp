@@ -12,8 +12,7 @@ RealWalker::RealWalker(int d, int numSteps, const UniformRNG &rng_in, hull_algor
 void RealWalker::reconstruct()
 {
     // write new gaussian random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
     init();
 }
 
@@ -50,13 +49,10 @@ void RealWalker::change(UniformRNG &rng, bool update)
         random_numbers[rnidx + i] = rng();
 
     m_steps[idx] = genStep(random_numbers.begin() + rnidx);
-    updatePoints(idx+1);
+    updatePointsLazy(idx+1);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 void RealWalker::undoChange()
@@ -66,6 +62,6 @@ void RealWalker::undoChange()
         random_numbers[undo_index * d + t++] = i;
 
     m_steps[undo_index] = genStep(undo_values.begin());
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
@@ -15,7 +15,7 @@ void ResetWalker::reconstruct()
     if(!amnesia)
     {
         // write new random numers into our state
-        std::generate(random_numbers.begin(), random_numbers.end(), std::ref(rng));
+        rng.fill(random_numbers);
     }
     init();
 }
@@ -67,27 +67,55 @@ void ResetWalker::updateSteps()
     }
 }
 
+/// Step i as in updateSteps(), with point i already in place.
+Step<int> ResetWalker::genStep(int i) const
+{
+    const double rn = random_numbers[i];
+    if(rn < resetrate)
+        return -m_points[i] + Step<int>(d, rn/resetrate);
+    return Step<int>(d, rn/(1-resetrate));
+}
+
+/// Index of the first reset after step i, or numSteps if there is none.
+int ResetWalker::nextReset(int i) const
+{
+    for(++i; i<numSteps; ++i)
+        if(random_numbers[i] < resetrate)
+            break;
+    return i;
+}
+
 /** Changes the walk, i.e., performs one trial move.
+ *
+ * Only the points up to the next reset are moved, by the difference
+ * of the old and new step. The jump back to the origin at the next
+ * reset absorbs this difference, such that all following excursions
+ * are unchanged. This holds also, if the changed step starts or stops
+ * to be a reset itself. Therefore, a change costs O(length of the
+ * excursion) and with CH_SEGMENT_TREE only the hulls of the touched
+ * blocks are merged again.
  *
  * \param rng Random number generator to draw the needed randomness from
  * \param update Should the hull be updated after the change?
  */
 void ResetWalker::change(UniformRNG &rng, bool update)
 {
-    // I should do this in a far more clever way
     int idx = rng() * numSteps;
     undo_index = idx;
     undo_value = random_numbers[idx];
     random_numbers[idx] = rng();
 
-    updateSteps();
-    updatePoints();
+    undo_step = m_steps[idx];
+    m_steps[idx] = genStep(idx);
+    undo_delta = m_steps[idx] - undo_step;
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    undo_end = nextReset(idx);
+    translate(m_points.data() + idx + 1, std::min(undo_end, numSteps) - idx, undo_delta);
+    if(undo_end < numSteps)
+        m_steps[undo_end] -= undo_delta;
+
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, std::min(undo_end, numSteps-1), update);
 }
 
 /// Undoes the last change.
@@ -95,9 +123,12 @@ void ResetWalker::undoChange()
 {
     random_numbers[undo_index] = undo_value;
 
-    updateSteps();
-    updatePoints();
-    m_convex_hull = m_old_convex_hull;
+    m_steps[undo_index] = undo_step;
+    translate(m_points.data() + undo_index + 1, std::min(undo_end, numSteps) - undo_index, -undo_delta);
+    if(undo_end < numSteps)
+        m_steps[undo_end] += undo_delta;
+
+    m_convex_hull.rollback();
 }
 
 void ResetWalker::setP1(double p1)
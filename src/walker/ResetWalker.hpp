@@ -12,6 +12,10 @@
  *
  * A Walk which resets with probability p.
  *
+ * Since every reset jumps back to the origin, the walk consists of
+ * independent excursions. A change of one step only moves the points
+ * up to the next reset, the following excursions stay untouched.
+ *
  * See also:
  * doi: 10.1103/PhysRevLett.106.160601
  *
@@ -37,6 +41,13 @@ class ResetWalker final : public SpecWalker<int>
         double maxlen_partialwalk() const final;
 
     protected:
+        Step<int> genStep(int i) const;
+        int nextReset(int i) const;
+
+        Step<int> undo_step;
+        Step<int> undo_delta;
+        int undo_end;
+
         int m_num_resets;
         int m_longest_streak;
         double m_longest_partial_walk;
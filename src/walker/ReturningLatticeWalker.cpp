@@ -21,7 +21,7 @@ ReturningLatticeWalker::ReturningLatticeWalker(int d, int numSteps, const Unifor
 void ReturningLatticeWalker::reconstruct()
 {
     // write new random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(), std::ref(rng));
+    rng.fill(random_numbers);
 
     permutation.sort();
     permutation.shuffle(random_numbers.begin(), random_numbers.end());
@@ -41,6 +41,7 @@ void ReturningLatticeWalker::updateSteps()
 
 void ReturningLatticeWalker::change(UniformRNG &rng, bool update)
 {
+    forgetChange();
     int idx = rng() * numSteps;
     int offset = numSteps / 2;
     undo_index = idx;
@@ -52,12 +53,16 @@ void ReturningLatticeWalker::change(UniformRNG &rng, bool update)
         newStep.fillFromRN(random_numbers[idx]);
         // test if something changes
         if(newStep == m_steps[idx])
+        {
+            changedNothing();
             return;
+        }
 
-        m_steps[permutation.inverse(idx)+offset] = -Step<int>(d, newStep.readToRN());
+        // the returning step is changed as well, such that only the
+        // points in between move
+        undo_swap = permutation.inverse(idx) + offset;
+        m_steps[undo_swap] = -Step<int>(d, newStep.readToRN());
         m_steps[idx].swap(newStep);
-
-        updatePoints(idx+1);
     }
     else
     {
@@ -65,19 +70,19 @@ void ReturningLatticeWalker::change(UniformRNG &rng, bool update)
 
         permutation.swap(idx-offset, undo_swap-offset);
         m_steps[idx].swap(m_steps[undo_swap]);
-
-        updatePoints(std::min(undo_swap, idx)+1);
     }
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    const int first = std::min(undo_swap, idx);
+    const int last = std::max(undo_swap, idx);
+    updatePointsRange(first, last);
+
+    m_convex_hull.beginTrial();
+    updateHullPartial(first, last, update);
 }
 
 void ReturningLatticeWalker::undoChange()
 {
+    forgetChange();
     int offset = numSteps / 2;
     if(undo_index < offset)
     {
@@ -87,17 +92,15 @@ void ReturningLatticeWalker::undoChange()
         if(newStep == m_steps[undo_index])
             return;
 
-        m_steps[permutation.inverse(undo_index)+offset] = -Step<int>(d, undo_value);
+        m_steps[undo_swap] = -Step<int>(d, undo_value);
         m_steps[undo_index].swap(newStep);
-
     }
     else
     {
         permutation.swap(undo_index-offset, undo_swap-offset);
         m_steps[undo_index].swap(m_steps[undo_swap]);
-        updatePoints(std::min(undo_swap, undo_index)+1);
     }
 
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsRange(std::min(undo_swap, undo_index), std::max(undo_swap, undo_index));
+    m_convex_hull.rollback();
 }
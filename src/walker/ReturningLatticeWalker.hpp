@@ -1,8 +1,6 @@
 #ifndef RETURNINGLATTICEWALKER_H
 #define RETURNINGLATTICEWALKER_H
 
-#include <map>
-
 #include "../Logging.hpp"
 #include "../Permutation.hpp"
 #include "SpecWalker.hpp"
@@ -27,7 +25,7 @@ class ReturningLatticeWalker final : public SpecWalker<int>
 
     private:
         Step<int> newStep;
-        int undo_swap;
+        int undo_swap; ///< index of the other step changed by the last change()
 
         Permutation permutation;
 };
@@ -16,11 +16,9 @@ RunAndTumbleWalker::RunAndTumbleWalker(int d, int numSteps, const UniformRNG &rn
 void RunAndTumbleWalker::reconstruct()
 {
     // write new gaussian random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
 
-    std::generate(random_tumble.begin(), random_tumble.end(),
-                  [this]{ return this->rng.uniform(); });
+    rng.fill(random_tumble);
 
     init();
 }
@@ -78,13 +76,10 @@ void RunAndTumbleWalker::change(UniformRNG &rng, bool update)
     }
 
     m_steps[idx] = genStep(idx);
-    updatePoints(idx+1);
+    updatePointsLazy(idx+1);
 
-    if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
-    }
+    m_convex_hull.beginTrial();
+    updateHullPartial(idx, idx, update);
 }
 
 void RunAndTumbleWalker::undoChange()
@@ -95,6 +90,6 @@ void RunAndTumbleWalker::undoChange()
     random_tumble[undo_index] = undo_tumble;
 
     m_steps[undo_index] = genStep(undo_index);
-    updatePoints(undo_index+1);
-    m_convex_hull = m_old_convex_hull;
+    updatePointsLazy(undo_index+1);
+    m_convex_hull.rollback();
 }
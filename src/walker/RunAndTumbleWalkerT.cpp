@@ -17,11 +17,9 @@ RunAndTumbleWalkerT::RunAndTumbleWalkerT(int d, int numSteps, const UniformRNG &
 void RunAndTumbleWalkerT::reconstruct()
 {
     // write new gaussian random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(),
-                  [this]{ return this->rng.gaussian(); });
+    rng.fill_gaussian(random_numbers);
 
-    std::generate(random_tumble.begin(), random_tumble.end(),
-                  [this]{ return this->rng.uniform(); });
+    rng.fill(random_tumble);
 
     init();
 }
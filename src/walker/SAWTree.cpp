@@ -0,0 +1,413 @@
+#include "SAWTree.hpp"
+
+#include "../geometry.hpp"
+
+SAWTree::SAWTree(int d)
+    : d(d),
+      numLeaves(0)
+{
+}
+
+/** Signed permutation of a symmetry matrix.
+ *
+ * Entry i is +-(j+1), if the matrix maps axis j to +- axis i.
+ *
+ * \param matrix row major d x d matrix with exactly one +-1 per row
+ * \param d dimension
+ */
+Step<int> SAWTree::symmetry(const int *matrix, int d)
+{
+    Step<int> g(d);
+    for(int i=0; i<d; ++i)
+        for(int j=0; j<d; ++j)
+            if(matrix[i*d + j])
+                g[i] = matrix[i*d + j] * (j+1);
+    return g;
+}
+
+/// Applies the signed permutation g to p.
+Step<int> SAWTree::apply(const Step<int> &g, const Step<int> &p)
+{
+    Step<int> out(p.d());
+    for(int i=0; i<p.d(); ++i)
+        out[i] = g[i] > 0 ? p[g[i]-1] : -p[-g[i]-1];
+    return out;
+}
+
+/// Signed permutation which applies first h and then g.
+Step<int> SAWTree::compose(const Step<int> &g, const Step<int> &h)
+{
+    Step<int> out(g.d());
+    for(int i=0; i<g.d(); ++i)
+        out[i] = g[i] > 0 ? h[g[i]-1] : -h[-g[i]-1];
+    return out;
+}
+
+/// Signed permutation which undoes g.
+Step<int> SAWTree::inverse(const Step<int> &g)
+{
+    Step<int> out(g.d());
+    for(int i=0; i<g.d(); ++i)
+        out[std::abs(g[i])-1] = g[i] > 0 ? i+1 : -(i+1);
+    return out;
+}
+
+/// Builds the tree of the walk consisting of steps.
+void SAWTree::build(const std::vector<Step<int>> &steps)
+{
+    numLeaves = steps.size() + 1;
+    int size = 1;
+    while(size < numLeaves)
+        size *= 2;
+    nodes.assign(2*size, Node());
+
+    // the nodes of more than hullLeafSize leaves are the first levels
+    int hullNodes = 1;
+    for(int range=numLeaves; range>hullLeafSize; range=(range+1)/2)
+        hullNodes *= 2;
+    hulls.assign(hasHulls() ? hullNodes : 0, Hull());
+
+    build(1, 0, numLeaves, steps);
+}
+
+void SAWTree::build(int n, int l, int r, const std::vector<Step<int>> &steps)
+{
+    nodes[n].tagged = false;
+    if(r - l == 1)
+    {
+        nodes[n].end = l ? steps[l-1] : Step<int>(d);
+        nodes[n].lo = nodes[n].end;
+        nodes[n].hi = nodes[n].end;
+        return;
+    }
+
+    int m = (l + r) / 2;
+    build(2*n, l, m, steps);
+    build(2*n+1, m, r, steps);
+    pull(n, l, r);
+}
+
+/// Transforms the sub-walk of node n by g around its starting point.
+void SAWTree::applyNode(int n, const Step<int> &g)
+{
+    Node &node = nodes[n];
+    node.end = apply(g, node.end);
+    Step<int> lo(d), hi(d);
+    for(int i=0; i<d; ++i)
+    {
+        if(g[i] > 0)
+        {
+            lo[i] = node.lo[g[i]-1];
+            hi[i] = node.hi[g[i]-1];
+        }
+        else
+        {
+            lo[i] = -node.hi[-g[i]-1];
+            hi[i] = -node.lo[-g[i]-1];
+        }
+    }
+    node.lo = lo;
+    node.hi = hi;
+
+    node.tag = node.tagged ? compose(g, node.tag) : g;
+    node.tagged = true;
+
+    if(hasHull(n))
+    {
+        Hull &h = hulls[n];
+        h.frame = h.framed ? compose(g, h.frame) : g;
+        h.framed = true;
+    }
+}
+
+/// Passes the lazy symmetry of an inner node on to its children.
+void SAWTree::push(int n)
+{
+    if(!nodes[n].tagged)
+        return;
+
+    applyNode(2*n, nodes[n].tag);
+    applyNode(2*n+1, nodes[n].tag);
+    nodes[n].tagged = false;
+}
+
+/// Vertices of the hull of some points, counterclockwise, the points are sorted.
+static void hullVertices(std::vector<Step<int>> &points, std::vector<Step<int>> &hull)
+{
+    std::sort(points.begin(), points.end());
+    const int m = points.size();
+    hull.resize(2*m);
+
+    int k = 0;
+    for(int i=0; i<m; ++i)
+    {
+        while(k >= 2 && cross2d_z(hull[k-2], hull[k-1], points[i]) <= 0)
+            --k;
+        hull[k++] = points[i];
+    }
+    for(int i=m-2, t=k+1; i>=0; --i)
+    {
+        while(k >= t && cross2d_z(hull[k-2], hull[k-1], points[i]) <= 0)
+            --k;
+        hull[k++] = points[i];
+    }
+
+    // without the closing point
+    hull.resize(std::max(1, k-1));
+}
+
+/** Recalculates end vector and bounding box of node n from its children.
+ *
+ * And the hull, if the node has one, from the hulls or points of its
+ * children.
+ */
+void SAWTree::pull(int n, int l, int r)
+{
+    const Node &a = nodes[2*n];
+    const Node &b = nodes[2*n+1];
+    Node &node = nodes[n];
+    node.end = a.end + b.end;
+    node.lo = a.lo;
+    node.hi = a.hi;
+    for(int i=0; i<d; ++i)
+    {
+        node.lo[i] = std::min(node.lo[i], a.end[i] + b.lo[i]);
+        node.hi[i] = std::max(node.hi[i], a.end[i] + b.hi[i]);
+    }
+
+    if(!hasHulls() || r - l <= hullLeafSize)
+        return;
+
+    const int m = (l + r) / 2;
+    hullBuffer.clear();
+    gather(2*n, l, m, nullptr, Step<int>(d), hullBuffer);
+    gather(2*n+1, m, r, nullptr, a.end, hullBuffer);
+    hullVertices(hullBuffer, hulls[n].vertices);
+    hulls[n].framed = false;
+}
+
+/** Appends the hull vertices or, if there is no hull, all points of node n.
+ *
+ * \param g symmetry of the ancestors, which is still to be applied, or nullptr
+ * \param pos starting point of the sub-walk
+ */
+void SAWTree::gather(int n, int l, int r, const Step<int> *g, const Step<int> &pos, std::vector<Step<int>> &out) const
+{
+    if(hasHull(n))
+    {
+        const Hull &h = hulls[n];
+        Step<int> c;
+        const Step<int> *pc = g;
+        if(h.framed)
+        {
+            c = g ? compose(*g, h.frame) : h.frame;
+            pc = &c;
+        }
+        for(const auto &v : h.vertices)
+            out.push_back(pos + (pc ? apply(*pc, v) : v));
+        return;
+    }
+
+    const Node &node = nodes[n];
+    if(r - l == 1)
+    {
+        out.push_back(pos + (g ? apply(*g, node.end) : node.end));
+        return;
+    }
+
+    Step<int> c;
+    const Step<int> *pc = g;
+    if(node.tagged)
+    {
+        c = g ? compose(*g, node.tag) : node.tag;
+        pc = &c;
+    }
+    const int m = (l + r) / 2;
+    const Step<int> &e = nodes[2*n].end;
+    gather(2*n, l, m, pc, pos, out);
+    gather(2*n+1, m, r, pc, pos + (pc ? apply(*pc, e) : e), out);
+}
+
+/// Vertices of the hull of the whole walk, or all points for short walks.
+void SAWTree::hull(std::vector<Step<int>> &out) const
+{
+    out.clear();
+    gather(1, 0, numLeaves, nullptr, Step<int>(d), out);
+}
+
+/// Step i with all lazy symmetries applied, O(log N).
+Step<int> SAWTree::step(int i) const
+{
+    int n = 1, l = 0, r = numLeaves;
+    Step<int> g;
+    bool tagged = false;
+    while(r - l > 1)
+    {
+        if(nodes[n].tagged)
+        {
+            g = tagged ? compose(g, nodes[n].tag) : nodes[n].tag;
+            tagged = true;
+        }
+        const int m = (l + r) / 2;
+        if(i+1 < m)
+        {
+            n = 2*n;
+            r = m;
+        }
+        else
+        {
+            n = 2*n+1;
+            l = m;
+        }
+    }
+    return tagged ? apply(g, nodes[n].end) : nodes[n].end;
+}
+
+/// Writes all steps with all lazy symmetries applied to out, O(N).
+void SAWTree::steps(std::vector<Step<int>> &out) const
+{
+    out.resize(numLeaves - 1);
+    collectSteps(1, 0, numLeaves, nullptr, out);
+}
+
+void SAWTree::collectSteps(int n, int l, int r, const Step<int> *g, std::vector<Step<int>> &out) const
+{
+    const Node &node = nodes[n];
+    if(r - l == 1)
+    {
+        if(l)
+            out[l-1] = g ? apply(*g, node.end) : node.end;
+        return;
+    }
+
+    Step<int> c;
+    const Step<int> *pc = g;
+    if(node.tagged)
+    {
+        c = g ? compose(*g, node.tag) : node.tag;
+        pc = &c;
+    }
+    const int m = (l + r) / 2;
+    collectSteps(2*n, l, m, pc, out);
+    collectSteps(2*n+1, m, r, pc, out);
+}
+
+/** Applies the symmetry g to all steps starting with step first.
+ *
+ * i.e., pivots the walk around point first.
+ */
+void SAWTree::transformSuffix(int first, const Step<int> &g)
+{
+    transform(1, 0, numLeaves, first+1, g);
+}
+
+void SAWTree::transform(int n, int l, int r, int first, const Step<int> &g)
+{
+    if(r <= first)
+        return;
+    if(l >= first)
+    {
+        applyNode(n, g);
+        return;
+    }
+
+    push(n);
+    int m = (l + r) / 2;
+    transform(2*n, l, m, first, g);
+    transform(2*n+1, m, r, first, g);
+    pull(n, l, r);
+}
+
+/// Replaces step i by s.
+void SAWTree::setStep(int i, const Step<int> &s)
+{
+    set(1, 0, numLeaves, i+1, s);
+}
+
+void SAWTree::set(int n, int l, int r, int i, const Step<int> &s)
+{
+    if(r - l == 1)
+    {
+        nodes[n].end = s;
+        nodes[n].lo = s;
+        nodes[n].hi = s;
+        nodes[n].tagged = false;
+        return;
+    }
+
+    push(n);
+    int m = (l + r) / 2;
+    if(i < m)
+        set(2*n, l, m, i, s);
+    else
+        set(2*n+1, m, r, i, s);
+    pull(n, l, r);
+}
+
+/** Do the points up to point first and the points behind it intersect?
+ *
+ * Both parts need to be self-avoiding on their own, which is the
+ * case after pivoting or changing step first of a self-avoiding walk.
+ */
+bool SAWTree::intersects(int first)
+{
+    prefix.clear();
+    suffix.clear();
+    Step<int> pos(d);
+    decompose(1, 0, numLeaves, first+1, pos);
+
+    // sub-walks close to the pivot are most likely to intersect
+    for(auto a = prefix.rbegin(); a != prefix.rend(); ++a)
+        for(const auto &b : suffix)
+            if(intersect(*a, b))
+                return true;
+    return false;
+}
+
+/// Splits the leaves into maximal nodes before and behind split.
+void SAWTree::decompose(int n, int l, int r, int split, Step<int> &pos)
+{
+    if(r <= split || l >= split)
+    {
+        (r <= split ? prefix : suffix).push_back({n, l, r, pos});
+        pos += nodes[n].end;
+        return;
+    }
+
+    push(n);
+    int m = (l + r) / 2;
+    decompose(2*n, l, m, split, pos);
+    decompose(2*n+1, m, r, split, pos);
+}
+
+bool SAWTree::intersect(const Part &a, const Part &b)
+{
+    const Node &na = nodes[a.node];
+    const Node &nb = nodes[b.node];
+    for(int i=0; i<d; ++i)
+        if(a.offset[i] + na.lo[i] > b.offset[i] + nb.hi[i]
+            || b.offset[i] + nb.lo[i] > a.offset[i] + na.hi[i])
+            return false;
+
+    // two single points with overlapping bounding boxes
+    if(a.r - a.l == 1 && b.r - b.l == 1)
+        return true;
+
+    // descend into the larger sub-walk
+    if(a.r - a.l >= b.r - b.l)
+    {
+        push(a.node);
+        int m = (a.l + a.r) / 2;
+        const Part left = {2*a.node, a.l, m, a.offset};
+        const Part right = {2*a.node+1, m, a.r, a.offset + nodes[2*a.node].end};
+        return intersect(left, b) || intersect(right, b);
+    }
+    else
+    {
+        push(b.node);
+        int m = (b.l + b.r) / 2;
+        const Part left = {2*b.node, b.l, m, b.offset};
+        const Part right = {2*b.node+1, m, b.r, b.offset + nodes[2*b.node].end};
+        return intersect(a, left) || intersect(a, right);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef SAWTREE_H
+#define SAWTREE_H
+
+#include <vector>
+
+#include "../Step.hpp"
+
+/** Balanced binary tree of sub-walks for fast self-intersection tests.
+ *
+ * Similar to the SAW-tree of Clisby, J. Stat. Phys. 140, 349 (2010).
+ * Every node stores the end vector and the bounding box of its
+ * sub-walk relative to its starting point and a lazy symmetry
+ * operation, which is still to be applied to its children.
+ * Lattice symmetries are signed permutations of the axes, they map
+ * bounding boxes exactly onto bounding boxes.
+ *
+ * Since a pivot does not change the length of any sub-walk, the shape
+ * of the tree is static: transforming all steps behind a pivot or
+ * exchanging a single step is O(log N). The test whether the points
+ * before and behind a site intersect descends only into pairs of
+ * sub-walks with overlapping bounding boxes.
+ *
+ * In d=2 every node of more than hullLeafSize leaves also stores the
+ * vertices of the convex hull of its sub-walk, with a lazy symmetry
+ * like the children. A node merges the hulls of its children, such
+ * that after a pivot or the change of a step only the O(log N) nodes
+ * above it merge their hulls and the hull of the whole walk is known
+ * without the steps behind the pivot being transformed.
+ *
+ * Internally leaf 0 is a zero step, such that leaf k ends at point k
+ * of the walk.
+ */
+class SAWTree
+{
+    public:
+        SAWTree(int d=0);
+
+        void build(const std::vector<Step<int>> &steps);
+
+        void transformSuffix(int first, const Step<int> &g);
+        void setStep(int i, const Step<int> &s);
+        bool intersects(int first);
+
+        /// end point of the whole walk
+        const Step<int>& end() const { return nodes[1].end; }
+
+        Step<int> step(int i) const;
+        void steps(std::vector<Step<int>> &out) const;
+
+        /// are the hulls of the sub-walks stored, i.e., is d=2?
+        bool hasHulls() const { return d == 2; }
+        void hull(std::vector<Step<int>> &out) const;
+
+        static Step<int> symmetry(const int *matrix, int d);
+        static Step<int> apply(const Step<int> &g, const Step<int> &p);
+        static Step<int> compose(const Step<int> &g, const Step<int> &h);
+        static Step<int> inverse(const Step<int> &g);
+
+    protected:
+        struct Node
+        {
+            Step<int> end;  ///< end vector of the sub-walk
+            Step<int> lo;   ///< lower corner of the bounding box
+            Step<int> hi;   ///< upper corner of the bounding box
+            Step<int> tag;  ///< symmetry still to be applied to the children
+            bool tagged;
+        };
+
+        /// hull of the sub-walk of a node
+        struct Hull
+        {
+            std::vector<Step<int>> vertices; ///< counterclockwise, empty if the node has no hull
+            Step<int> frame;                 ///< symmetry still to be applied to the vertices
+            bool framed;
+        };
+
+        /// a sub-walk covering the leaves [l, r), starting at offset
+        struct Part
+        {
+            int node;
+            int l;
+            int r;
+            Step<int> offset;
+        };
+
+        void build(int n, int l, int r, const std::vector<Step<int>> &steps);
+        void applyNode(int n, const Step<int> &g);
+        void push(int n);
+        void pull(int n, int l, int r);
+        bool hasHull(int n) const { return n < (int) hulls.size() && !hulls[n].vertices.empty(); }
+        void gather(int n, int l, int r, const Step<int> *g, const Step<int> &pos, std::vector<Step<int>> &out) const;
+        void collectSteps(int n, int l, int r, const Step<int> *g, std::vector<Step<int>> &out) const;
+
+        void transform(int n, int l, int r, int first, const Step<int> &g);
+        void set(int n, int l, int r, int i, const Step<int> &s);
+        void decompose(int n, int l, int r, int split, Step<int> &pos);
+        bool intersect(const Part &a, const Part &b);
+
+        static const int hullLeafSize = 16;
+
+        int d;
+        int numLeaves;
+        std::vector<Node> nodes;
+        std::vector<Hull> hulls;        ///< only for nodes of more than hullLeafSize leaves
+        std::vector<Step<int>> hullBuffer;
+        std::vector<Part> prefix;
+        std::vector<Part> suffix;
+};
+
+#endif
@@ -1,5 +1,95 @@
 #include "ScentWalker.hpp"
 
+#ifndef _OPENMP
+   #define omp_get_max_threads() 1
+   #define omp_in_parallel() 0
+#endif
+
+/// Sets the mark of walker to time.
+void Site::mark(int walker, int time)
+{
+    for(auto &m : marks)
+        if(m.first == walker)
+        {
+            m.second = time;
+            return;
+        }
+    marks.emplace_back(walker, time);
+}
+
+/// Removes all marks older than time.
+void Site::expire(int time)
+{
+    marks.erase(
+        std::remove_if(marks.begin(), marks.end(),
+            [time](const std::pair<int, int> &m){ return m.second < time; }),
+        marks.end()
+    );
+}
+
+bool Site::has(int walker) const
+{
+    for(const auto &m : marks)
+        if(m.first == walker)
+            return true;
+    return false;
+}
+
+Field::Field(int d, int sideLength)
+    : d(d),
+      sideLength(sideLength),
+      stamp(1)
+{
+    size_t n = d > 0 ? 1 : 0;
+    for(int k=0; k<d; ++k)
+        n *= sideLength;
+    sites.resize(n);
+    stamps.resize(n, 0);
+}
+
+int Field::index(const Step<int> &p)
+{
+    int idx = 0;
+    for(int k=d-1; k>=0; --k)
+    {
+        if(p[k] < 0 || p[k] >= sideLength)
+        {
+            int *i = outside.find(p);
+            if(i)
+                return *i;
+            outside.insert(p, sites.size());
+            sites.emplace_back();
+            stamps.push_back(0);
+            return sites.size() - 1;
+        }
+        idx = idx * sideLength + p[k];
+    }
+    return idx;
+}
+
+/// scent marks of site p
+Site& Field::operator[](const Step<int> &p)
+{
+    const int idx = index(p);
+    if(stamps[idx] != stamp)
+    {
+        sites[idx].clear();
+        stamps[idx] = stamp;
+    }
+    return sites[idx];
+}
+
+void Field::clear()
+{
+    ++stamp;
+    // after a wrap around old stamps would be valid again
+    if(stamp == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+}
+
 ScentWalker::ScentWalker(int d, int numSteps, int numWalker_in, int sideLength_in, int Tas_in, agent_start_t start_configuration_in, const UniformRNG &rng, hull_algorithm_t hull_algo, bool amnesia, bool save_histograms_in)
     : SpecWalker<int>(d, numSteps, rng, hull_algo, amnesia),
       numWalker(numWalker_in),
@@ -8,10 +98,28 @@ ScentWalker::ScentWalker(int d, int numSteps, int numWalker_in, int sideLength_i
       relax(start_configuration_in == AS_RELAXED ? Tas_in : 0),
       periodic(d == 1),
       start_configuration(start_configuration_in),
-      save_histograms(save_histograms_in)
+      save_histograms(save_histograms_in),
+      minParallelWalkers(64),
+      initial_trail(d, sideLength_in),
+      trail(d, sideLength_in),
+      scratch(1)
 {
     m_steps.resize(numSteps);
 
+    // all offsets with 1 <= |o|_1 <= 2 in the cell index of the world
+    std::vector<int> strides(d, 1);
+    for(int k=1; k<d; ++k)
+        strides[k] = strides[k-1] * sideLength;
+    for(int a=0; a<d; ++a)
+        for(int s : {1, -1})
+        {
+            near_offsets.push_back(s * strides[a]);
+            near_offsets.push_back(2 * s * strides[a]);
+            for(int b=a+1; b<d; ++b)
+                for(int t : {1, -1})
+                    near_offsets.push_back(s * strides[a] + t * strides[b]);
+        }
+
     updatedNumWalker();
     reconstruct();
 }
@@ -162,7 +270,7 @@ void ScentWalker::reconstruct()
             {
                 for(int j=0; j<numWalker; ++j)
                 {
-                    moveWalker(j, i, initial_trail, true);
+                    moveWalker(j, i, initial_trail, rng());
                 }
             }
             // also shift the starting position to the relaxed position
@@ -188,25 +296,22 @@ int ScentWalker::interactions(int walkerId)
 
 void ScentWalker::updateField(Site &site, int time)
 {
-    // static -> vector will be allocated only once
-    static std::vector<int> to_remove;
-    to_remove.clear();
-
-    for(const auto &k : site)
-        if(k.second < time-Tas)
-            to_remove.push_back(k.first);
-
-    for(auto &k : to_remove)
-        site.erase(k);
+    site.expire(time-Tas);
 }
 
-void ScentWalker::moveWalker(int j, int i, Field &trail, bool forced_amnesia)
+/** Moves walker j at time i.
+ *
+ * \param rn is the random number of this move, which is used either
+ *           for a random step or to choose where to retreat
+ * \param thread is the index of the scratch buffers to use
+ */
+void ScentWalker::moveWalker(int j, int i, Field &trail, double rn, int thread)
 {
     auto &current = trail[pos[j]];
 
     //  at every visit remove expired entries from the back of the deque
     //  and entries of oneself (because oneself left a new scent in that moment)
-    current[j] = i; // update last visited
+    current.mark(j, i); // update last visited
 
     updateField(current, i);
 
@@ -215,19 +320,31 @@ void ScentWalker::moveWalker(int j, int i, Field &trail, bool forced_amnesia)
     if(current.size() > 1 && i > 0)
     {
         // record with which adversary we interacted
-        for(auto &field_entry : current)
+        for(const auto &field_entry : current)
         {
             int adversary = field_entry.first;
             if(adversary != j) // do not record yourself
                 interaction_sets[j].insert(adversary);
         }
 
-        std::vector<Step<int>> candidates;
-        for(auto &k : pos[j].neighbors())
+        auto &neighbors = scratch[thread].neighbors;
+        auto &candidates = scratch[thread].candidates;
+
+        // neighbors in the same order as Step::neighbors(), without allocating
+        neighbors.resize(2*d, pos[j]);
+        for(int k=0; k<2*d; ++k)
+        {
+            neighbors[k] = pos[j];
+            neighbors[k][k/2] += k % 2 ? -1 : 1;
+            neighbors[k].periodic(sideLength);
+        }
+
+        candidates.clear();
+        for(const auto &k : neighbors)
         {
-            k.periodic(sideLength);
             // retreat only on own scent to not trap yourself behind a bridge
-            if(trail[k].size() == 1 && trail[k].find(j) != trail[k].end())
+            const Site &site = trail[k];
+            if(site.size() == 1 && site.has(j))
                 candidates.push_back(k);
         }
 
@@ -235,12 +352,9 @@ void ScentWalker::moveWalker(int j, int i, Field &trail, bool forced_amnesia)
         {
             // if we can not find a site without adversary scent, retreat on
             // any site which also has own scent
-            for(auto &k : pos[j].neighbors())
-            {
-                k.periodic(sideLength);
-                if(trail[k].find(j) != trail[k].end())
+            for(const auto &k : neighbors)
+                if(trail[k].has(j))
                     candidates.push_back(k);
-            }
         }
 
         if(candidates.size() == 0)
@@ -249,18 +363,11 @@ void ScentWalker::moveWalker(int j, int i, Field &trail, bool forced_amnesia)
             // happen
             LOG(LOG_WARNING) << j << " is stuck! at t = " << i;
             // we are stuck, so just intrude into the other territory, I guess
-            if(!amnesia && !forced_amnesia)
-                step[j].fillFromRN(random_numbers[(i-relax)*numWalker + j]);
-            else
-                step[j].fillFromRN(rng());
+            step[j].fillFromRN(rn);
         }
         else
         {
-            int idx;
-            if(!amnesia && !forced_amnesia)
-                idx = random_numbers[(i-relax)*numWalker + j] * candidates.size();
-            else
-                idx = rng() * candidates.size();
+            int idx = rn * candidates.size();
             step[j] = candidates[idx] - pos[j];
         }
 
@@ -269,10 +376,7 @@ void ScentWalker::moveWalker(int j, int i, Field &trail, bool forced_amnesia)
     else
     {
         // else do a random step
-        if(!amnesia && !forced_amnesia)
-            step[j].fillFromRN(random_numbers[(i-relax)*numWalker + j]);
-        else
-            step[j].fillFromRN(rng());
+        step[j].fillFromRN(rn);
         pos[j] += step[j];
     }
 
@@ -304,8 +408,6 @@ void ScentWalker::updateSteps()
 {
     // use numWalker vectors for the steps (scent traces will be steps[now-Tas:now])
     // every walker has its own history
-    // static -> will be allocated only once
-    static Field trail(std::min(sideLength*sideLength, numSteps*numWalker));
     // in the relaxed start configuration we have scent marks on the initial map
     if(start_configuration == AS_RELAXED)
     {
@@ -331,11 +433,28 @@ void ScentWalker::updateSteps()
     }
 
     // iterate the time, every agent does one move each timestep
+    // within a parallel region, e.g., of parallel tempering, or with a
+    // single thread the decomposition has only overhead
+    const bool decompose = minParallelWalkers == 0
+                           || (numWalker >= minParallelWalkers
+                               && !omp_in_parallel()
+                               && omp_get_max_threads() > 1);
     for(int i=relax; i<numSteps+relax; ++i)
     {
+        if(decompose)
+        {
+            moveDecomposed(i);
+
+            if(save_histograms)
+                for(int j=0; j<numWalker; ++j)
+                    histograms[j].add(pos[j]);
+            m_steps[i-relax] = step[0];
+            continue;
+        }
+
         for(int j=0; j<numWalker; ++j)
         {
-            moveWalker(j, i, trail);
+            moveWalker(j, i, trail, amnesia ? rng() : random_numbers[(i-relax)*numWalker + j]);
 
             if(save_histograms)
                 histograms[j].add(pos[j]);
@@ -345,6 +464,108 @@ void ScentWalker::updateSteps()
     }
 }
 
+/// index of the cell of p, if it is at least margin away from the
+/// border of the world, otherwise -1
+int ScentWalker::cell(const Step<int> &p, int margin) const
+{
+    int idx = 0;
+    for(int k=d-1; k>=0; --k)
+    {
+        if(p[k] < margin || p[k] >= sideLength - margin)
+            return -1;
+        idx = idx * sideLength + p[k];
+    }
+    return idx;
+}
+
+/** Moves all walkers by one time step, independent walkers in parallel.
+ *
+ * A walker only reads the scent on its site and the adjacent sites and
+ * only marks its own site. Walkers at a distance of more than 2 can
+ * therefore not influence each other within one time step. All walkers
+ * closer than that are moved one by one in the order of their ids,
+ * before the remaining walkers are moved in parallel. The result is
+ * thus the same as moving all walkers one by one, independent of the
+ * number of threads.
+ *
+ * Walkers near the border, which may touch sites outside of the world
+ * or wrap around, are also moved one by one.
+ * The random numbers are drawn before, in the order of the walkers.
+ */
+void ScentWalker::moveDecomposed(int i)
+{
+    const int n = numWalker;
+
+    step_rn.resize(n);
+    for(int j=0; j<n; ++j)
+        step_rn[j] = amnesia ? rng() : random_numbers[(i-relax)*n + j];
+
+    if(occupant.empty())
+    {
+        size_t volume = 1;
+        for(int k=0; k<d; ++k)
+            volume *= sideLength;
+        occupant.assign(volume, -1);
+    }
+
+    walker_cell.resize(n);
+    serial.assign(n, false);
+    for(int j=0; j<n; ++j)
+    {
+        if(cell(pos[j], 2) < 0)
+            serial[j] = true;
+
+        const int s = cell(pos[j], 0);
+        walker_cell[j] = s;
+        if(s < 0)
+            continue;
+        if(occupant[s] >= 0)
+            serial[j] = serial[occupant[s]] = true;
+        occupant[s] = j;
+    }
+
+    // the neighborhood of walkers not near the border is inside of the world
+    for(int j=0; j<n; ++j)
+    {
+        if(serial[j])
+            continue;
+        const int s = walker_cell[j];
+        for(int o : near_offsets)
+        {
+            const int k = occupant[s + o];
+            if(k >= 0)
+            {
+                serial[j] = serial[k] = true;
+                break;
+            }
+        }
+    }
+
+    order.clear();
+    for(int j=0; j<n; ++j)
+    {
+        if(walker_cell[j] >= 0)
+            occupant[walker_cell[j]] = -1;
+        if(serial[j])
+            order.push_back(j);
+    }
+    const int num_serial = order.size();
+    for(int j=0; j<n; ++j)
+        if(!serial[j])
+            order.push_back(j);
+
+    for(int k=0; k<num_serial; ++k)
+        moveWalker(order[k], i, trail, step_rn[order[k]]);
+
+    // the number of threads may have changed since the last time step
+    if((int) scratch.size() < omp_get_max_threads())
+        scratch.resize(omp_get_max_threads());
+
+    #pragma omp parallel for schedule(static)
+    for(int k=num_serial; k<n; ++k)
+        moveWalker(order[k], i, trail, step_rn[order[k]], omp_get_thread_num());
+}
+
 void ScentWalker::change(UniformRNG &rng, bool update)
 {
     // I should do this in a far more clever way
@@ -382,11 +603,9 @@ void ScentWalker::change(UniformRNG &rng, bool update)
     updateSteps();
     updatePoints();
 
+    m_convex_hull.beginTrial();
     if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
         updateHull();
-    }
 }
 
 void ScentWalker::undoChange()
@@ -402,7 +621,7 @@ void ScentWalker::undoChange()
 
     updateSteps();
     updatePoints();
-    m_convex_hull = m_old_convex_hull;
+    m_convex_hull.rollback();
 }
 
 void ScentWalker::svg(const std::string filename, const bool with_hull) const
@@ -2,23 +2,62 @@
 #define SCENTWALKER_H
 
 #include <unordered_set>
-#include <unordered_map>
-#include <map>
+#include <algorithm>
+#include <limits>
 
 #include "../Logging.hpp"
+#include "../LatticeMap.hpp"
 #include "../visualization/Svg.hpp"
 #include "../visualization/GnuplotContour.hpp"
 #include "../stat/HistogramND.hpp"
 #include "SpecWalker.hpp"
 
-/// tracks scent for one site
-typedef std::map<int, int> Site;
+/** tracks scent for one site
+ *
+ * list of (who, when), at most one mark per walker, usually only a few
+ */
+class Site
+{
+    public:
+        void mark(int walker, int time);
+        void expire(int time);
+        bool has(int walker) const;
+        size_t size() const { return marks.size(); }
+        void clear() { marks.clear(); }
+
+        std::vector<std::pair<int, int>>::const_iterator begin() const { return marks.begin(); }
+        std::vector<std::pair<int, int>>::const_iterator end() const { return marks.end(); }
 
-/** tracks the scent marks on the plane
+    protected:
+        std::vector<std::pair<int, int>> marks;
+};
+
+/** tracks the scent marks on the finite world
  *
- * hashmap: site -> (map: who -> when)
+ * Dense grid over all sideLength^d sites. clear() only invalidates
+ * the sites, such that their marks keep their memory and copies
+ * between fields of the same size do not allocate.
+ * Sites outside of the world, which can only be starting positions,
+ * get additional cells on demand.
  */
-typedef std::unordered_map<Step<int>, Site> Field;
+class Field
+{
+    public:
+        Field(int d=0, int sideLength=0);
+
+        Site& operator[](const Step<int> &p);
+        void clear();
+
+    protected:
+        int index(const Step<int> &p);
+
+        int d;
+        int sideLength;
+        std::vector<Site> sites;
+        std::vector<uint32_t> stamps;   ///< the site is valid, if it equals stamp
+        uint32_t stamp;
+        LatticeMap<int> outside;
+};
 
 /** Agent based random walk on a hypercube.
  *
@@ -31,6 +70,9 @@ typedef std::unordered_map<Step<int>, Site> Field;
  * If another walker encounters a foreign scent, it will retreat, i.e.,
  * will in the next step step on a site without that scent.
  *
+ * With many walkers, the walkers which can not influence each other
+ * within one time step are moved in parallel, see moveDecomposed().
+ *
  * See also: https://doi.org/10.1371/journal.pcbi.1002008
  *
  * \image html scent.png "histogram where different agents spend time"
@@ -68,12 +110,21 @@ class ScentWalker final : public SpecWalker<int>
 
         const bool save_histograms;   ///< save auxillary information for visualization
 
+        /// number of walkers from which on the independent walkers are
+        /// moved in parallel (only with more than one thread and not
+        /// within another parallel region), 0 always uses the
+        /// decomposition, also with a single thread
+        int minParallelWalkers;
+
     protected:
         std::vector<Step<int>> starts;  ///< initial positions of walkers
         Field initial_trail;            ///< initial trail configuration
+        Field trail;                    ///< current trail configuration
         std::vector<HistogramND> histograms;
 
-        void moveWalker(int j, int i, Field &trail, bool forced_amnesia=false);
+        void moveWalker(int j, int i, Field &trail, double rn, int thread=0);
+        void moveDecomposed(int i);
+        int cell(const Step<int> &p, int margin) const;
 
         Step<int> undo_start;
 
@@ -81,6 +132,21 @@ class ScentWalker final : public SpecWalker<int>
         std::vector<std::unordered_set<int>> interaction_sets;
 
         std::vector<Step<int>> step, pos;
+
+        /// buffers for the retreat of one walker, one per thread
+        struct Scratch
+        {
+            std::vector<Step<int>> neighbors, candidates;
+        };
+        std::vector<Scratch> scratch;
+
+        // state of the decomposition of a time step
+        std::vector<double> step_rn;    ///< random number of every walker in this time step
+        std::vector<int> near_offsets;  ///< cell offsets within a distance of 2
+        std::vector<int> occupant;      ///< some walker on every cell or -1
+        std::vector<int> walker_cell;   ///< cell of every walker or -1 outside
+        std::vector<char> serial;       ///< whether the walker has to be moved one by one
+        std::vector<int> order;         ///< serial walkers first, then the independent
 };
 
 #endif
@@ -175,11 +175,9 @@ void ScentWalker1D::change(UniformRNG &rng, bool update)
     updateSteps();
     updatePoints();
 
+    m_convex_hull.beginTrial();
     if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
         updateHull();
-    }
 }
 
 void ScentWalker1D::undoChange()
@@ -195,5 +193,5 @@ void ScentWalker1D::undoChange()
 
     updateSteps();
     updatePoints();
-    m_convex_hull = m_old_convex_hull;
+    m_convex_hull.rollback();
 }
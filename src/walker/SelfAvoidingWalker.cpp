@@ -277,12 +277,21 @@ static const int iMatrix4[] =
     19
 };
 
-SelfAvoidingWalker::SelfAvoidingWalker(int d, int numSteps, const UniformRNG &rng_in, hull_algorithm_t hull_algo, bool amnesia)
-    : SpecWalker<int>(d, numSteps, rng_in, hull_algo, amnesia)
+/** Starts with an equilibrated walk, or with a straight line if
+ * equilibrate is false, e.g., for tourPERM(), which replaces it anyway.
+ */
+SelfAvoidingWalker::SelfAvoidingWalker(int d, int numSteps, const UniformRNG &rng_in, hull_algorithm_t hull_algo, bool amnesia, bool equilibrate)
+    : SpecWalker<int>(d, numSteps, rng_in, hull_algo, amnesia),
+      tree(d)
 {
     overlap_test.reserve(numSteps);
-
-    generate_from_MCMC();
+    if(equilibrate)
+        generate_from_MCMC();
+    else
+    {
+        random_numbers = std::vector<double>(numSteps, 0.);
+        init();
+    }
 }
 
 /// Get new random numbers and reconstruct the walk
@@ -317,12 +326,186 @@ void SelfAvoidingWalker::generate_from_MCMC()
         change(rng, true);
 }
 
+/// log(exp(a) + exp(b)) without overflow
+static double logAdd(double a, double b)
+{
+    if(a == -std::numeric_limits<double>::infinity())
+        return b;
+    if(b == -std::numeric_limits<double>::infinity())
+        return a;
+    return std::max(a, b) + std::log1p(std::exp(-std::abs(a - b)));
+}
+
+/// starts the estimate of a single tour for walks of length n-1
+void SelfAvoidingWalker::PERMEstimate::reset(int n)
+{
+    tours = 1;
+    logSum.assign(n, -std::numeric_limits<double>::infinity());
+}
+
+void SelfAvoidingWalker::PERMEstimate::add(int n, double logW)
+{
+    logSum[n] = logAdd(logSum[n], logW);
+}
+
+void SelfAvoidingWalker::PERMEstimate::add(const PERMEstimate &other)
+{
+    if(logSum.empty())
+        logSum.assign(other.logSum.size(), -std::numeric_limits<double>::infinity());
+    for(size_t n=0; n<logSum.size(); ++n)
+        logSum[n] = logAdd(logSum[n], other.logSum[n]);
+    tours += other.tours;
+}
+
+/// log of Z_n estimated by this and the other estimate together
+double SelfAvoidingWalker::PERMEstimate::logZ(int n, const PERMEstimate &other) const
+{
+    const double sum = other.logSum.empty() ? logSum[n] : logAdd(logSum[n], other.logSum[n]);
+    return sum - std::log((double) (tours + other.tours));
+}
+
+/** One tour of the pruned-enriched Rosenbluth method (PERM).
+ *
+ * Grassberger, Phys. Rev. E 56, 3682 (1997).
+ * The walk grows depth first, every step is chosen uniformly among
+ * the free neighbors and the weight is multiplied by their number.
+ * If the weight exceeds three times the estimate of the partition sum
+ * at this length, the walk is enriched, i.e., continued twice with
+ * half the weight; below a third of the estimate it is pruned with
+ * probability 1/2 or continued with double the weight.
+ * The estimate combines the previous tours, which are passed in and
+ * not changed, with this tour, such that tours can be grown in
+ * parallel with reproducible results. Afterwards the weights of this
+ * tour are available as tourEstimate().
+ *
+ * For every walk reaching numSteps, this walker is set to it and
+ * sample is called with the logarithm of its weight. Averages of
+ * observables are weighted averages over all samples of all tours.
+ *
+ * \param rng random number generator for this tour
+ * \param sample called for every generated walk with its log weight
+ * \param previous estimate of the tours before, may be empty
+ */
+void SelfAvoidingWalker::tourPERM(UniformRNG &rng, const std::function<void(double)> &sample, const PERMEstimate &previous)
+{
+    static const double enrich = std::log(3.);
+    static const double prune = -std::log(3.);
+
+    perm_path.assign(numSteps+1, Step<int>(d));
+    perm_tour.reset(numSteps+1);
+    perm_stack.clear();
+    perm_free.reserve(2*d);
+    overlap_test.clear();
+    overlap_test.insert(perm_path[0], 0);
+
+    int n = 0;
+    double logW = 0;
+    while(true)
+    {
+        bool alive = true;
+        if(n == numSteps)
+        {
+            permSample();
+            sample(logW);
+            alive = false;
+        }
+        else
+        {
+            // free neighbors of the head
+            perm_free.clear();
+            for(int i=0; i<d; ++i)
+                for(int dir=-1; dir<=1; dir+=2)
+                {
+                    Step<int> q(perm_path[n]);
+                    q[i] += dir;
+                    if(permFree(q, n))
+                        perm_free.push_back(q);
+                }
+
+            if(perm_free.empty())
+                alive = false;
+            else
+            {
+                logW += std::log((double) perm_free.size());
+                const Step<int> &q = perm_free[rng() * perm_free.size()];
+                ++n;
+                perm_path[n] = q;
+                overlap_test[q] = n;
+
+                perm_tour.add(n, logW);
+                const double ratio = logW - perm_tour.logZ(n, previous);
+                if(ratio > enrich)
+                {
+                    logW -= std::log(2.);
+                    perm_stack.push_back({n, logW});
+                }
+                else if(ratio < prune)
+                {
+                    if(rng() < 0.5)
+                        alive = false;
+                    else
+                        logW += std::log(2.);
+                }
+            }
+        }
+
+        if(!alive)
+        {
+            if(perm_stack.empty())
+                break;
+            n = perm_stack.back().n;
+            logW = perm_stack.back().logW;
+            perm_stack.pop_back();
+        }
+    }
+}
+
+/// Is site p free for a walk consisting of the first n+1 points of the path?
+bool SelfAvoidingWalker::permFree(const Step<int> &p, int n) const
+{
+    // entries of sites we backtracked from are outdated, not erased
+    const int *i = overlap_test.find(p);
+    return !i || *i > n || !(perm_path[*i] == p);
+}
+
+/// Sets this walker to the walk of the current PERM path.
+void SelfAvoidingWalker::permSample()
+{
+    random_numbers.resize(numSteps);
+    for(int i=0; i<numSteps; ++i)
+    {
+        Step<int> s = perm_path[i+1] - perm_path[i];
+        random_numbers[i] = s.readToRN();
+    }
+    init();
+}
+
 void SelfAvoidingWalker::updateSteps()
 {
     m_steps.clear();
     m_steps.reserve(numSteps);
     for(int i=0; i<numSteps; ++i)
         m_steps.emplace_back(d, random_numbers[i]);
+    tree.build(m_steps);
+    m_steps_pending = false;
+}
+
+/// In d=2 the hull of the walk is the hull of the vertices of the tree.
+void SelfAvoidingWalker::updateHull()
+{
+    if(!tree.hasHulls())
+    {
+        SpecWalker<int>::updateHull();
+        return;
+    }
+
+    tree.hull(tree_hull);
+    m_convex_hull.runUnion({&tree_hull});
+}
+
+void SelfAvoidingWalker::fetchSteps() const
+{
+    tree.steps(m_steps);
 }
 
 /** Changes the walk, i.e., performs one trial move.
@@ -339,6 +522,7 @@ void SelfAvoidingWalker::updateSteps()
  */
 void SelfAvoidingWalker::change(UniformRNG &rng, bool update)
 {
+    forgetChange();
     // do a pivot change
     // choose the pivot
     int idx = rng() * nRN();
@@ -370,7 +554,14 @@ void SelfAvoidingWalker::change(UniformRNG &rng, bool update)
                 LOG(LOG_WARNING) << "Pivot algorithm only implemented for d<=3, "
                                     "will only use naive changes";
         }
-        pivot(idx, symmetry, update);
+        // the pivot is undone by the inverse pivot, not by a rollback
+        m_convex_hull.beginTrial();
+        if(!pivot(idx, symmetry, update))
+        {
+            // nothing to undo
+            undo_index = -1;
+            undo_naive_index = -1;
+        }
     }
     else // 50%
     {
@@ -384,9 +575,16 @@ void SelfAvoidingWalker::change(UniformRNG &rng, bool update)
 /// Undoes the last change.
 void SelfAvoidingWalker::undoChange()
 {
+    forgetChange();
     // which change was done
     if(undo_index == -1)
         naiveChangeUndo();
+    else if(tree.hasHulls())
+    {
+        // the hull is restored instead of recalculated
+        pivot(undo_index, undo_symmetry, false);
+        m_convex_hull.rollback();
+    }
     else
         pivot(undo_index, undo_symmetry);
 }
@@ -441,50 +639,30 @@ bool SelfAvoidingWalker::pivot(const int index, const int op, bool update)
             throw std::invalid_argument("Pivot algorithm only implemented for d<=4");
     }
 
-    // FIXME: pivot the shorter end
-    // first just a dry test -- most of the time it will fail and it is
-    // probably cheaper to do it twice in case of success instead of
-    // undo much work everytime
-    overlap_test.clear();
-    Step<int> positioni(d);
-    Step<int> positionj(d);
-    overlap_test.emplace(d);
-    bool failed = false;
-    // test for overlaps starting at the pivot point in both directions
-    for(int i=index-1, j=index; i>=0 || j<numSteps; --i, ++j)
+    // pivot in the tree and test -- most of the time it will fail
+    // and we pivot back, which is O(log N) in contrast to the steps
+    const Step<int> g = SAWTree::symmetry(matrix, d);
+    tree.transformSuffix(index, g);
+    bool failed = tree.intersects(index);
+    if(failed)
     {
-        if(i >= 0)
-        {
-            positioni -= m_steps[i];
-            if(overlap_test.count(positioni))
-            {
-                failed = true;
-                break;
-            }
-            overlap_test.insert(positioni);
-        }
-
-        if(j < numSteps)
-        {
-            positionj += transform(m_steps[j], matrix);
-            if(overlap_test.count(positionj))
-            {
-                failed = true;
-                break;
-            }
-            overlap_test.insert(positionj);
-        }
+        tree.transformSuffix(index, SAWTree::inverse(g));
+        changedNothing();
     }
-    if(!failed)
+    else if(tree.hasHulls())
+    {
+        // steps and points are fetched from the tree when needed
+        m_steps_pending = true;
+        if(update)
+            updateHull();
+    }
+    else
     {
         for(int i=index; i<numSteps; ++i)
             m_steps[i] = transform(m_steps[i], matrix);
 
         updatePoints(index+1);
-        if(update)
-        {
-            updateHull();
-        }
+        updateHullPartial(index, numSteps-1, update);
     }
 
     return !failed;
@@ -496,72 +674,69 @@ void SelfAvoidingWalker::naiveChangeUndo()
     if(undo_naive_index == -1)
         return;
 
-    m_steps[undo_naive_index] = undo_naive_step;
-
-    updatePoints(undo_naive_index+1);
-    m_convex_hull = m_old_convex_hull;
+    tree.setStep(undo_naive_index, undo_naive_step);
+    if(tree.hasHulls())
+        m_steps_pending = true;
+    else
+    {
+        m_steps[undo_naive_index] = undo_naive_step;
+        updatePoints(undo_naive_index+1);
+    }
+    m_convex_hull.rollback();
 }
 
 bool SelfAvoidingWalker::naiveChange(const int idx, const double rn, bool update)
 {
     undo_naive_index = idx;
-    undo_naive_step = m_steps[idx];
+    undo_naive_step = tree.step(idx);
 
     Step<int> newStep(d, rn);
     // test if something changes
-    if(newStep == m_steps[idx])
+    if(newStep == undo_naive_step)
+    {
+        // nothing to undo, especially not the hull
+        undo_naive_index = -1;
+        changedNothing();
         return true;
+    }
 
-    m_steps[idx] = newStep;
-    updatePoints(idx+1);
-
-    if(!checkOverlapFree(points()))
+    tree.setStep(idx, newStep);
+    if(tree.intersects(idx))
     {
-        m_steps[idx] = undo_naive_step;
-        updatePoints(idx+1);
+        tree.setStep(idx, undo_naive_step);
         undo_naive_index = -1;
+        changedNothing();
         return false;
     }
 
-    if(update)
+    m_convex_hull.beginTrial();
+    if(tree.hasHulls())
     {
-        m_old_convex_hull = m_convex_hull;
-        updateHull();
+        m_steps_pending = true;
+        if(update)
+            updateHull();
+        return true;
     }
 
-    return true;
-}
-
-bool SelfAvoidingWalker::checkOverlapFree(const std::vector<Step<int>> &l) const
-{
-    std::unordered_set<Step<int>> map;
-    map.reserve(l.size());
+    m_steps[idx] = newStep;
+    updatePoints(idx+1);
+    updateHullPartial(idx, idx, update);
 
-    auto it(l.begin());
-    while(it != l.end())
-    {
-        if(map.count(*it))
-            return false;
-        map.insert(*it);
-        ++it;
-    }
     return true;
 }
 
-bool SelfAvoidingWalker::checkOverlapFree(const std::list<double> &l) const
+/// Is the walk from the random numbers l self-avoiding? Reuses overlap_test.
+bool SelfAvoidingWalker::checkOverlapFree(const std::list<double> &l)
 {
-    std::unordered_set<Step<int>> map;
-    map.reserve(l.size());
+    overlap_test.clear();
 
-    auto it(l.begin());
+    int i = 0;
     Step<int> p(d);
-    while(it != l.end())
+    for(const double rn : l)
     {
-        p += Step<int>(d, *it);
-        if(map.count(p))
+        p += Step<int>(d, rn);
+        if(!overlap_test.insert(p, i++))
             return false;
-        map.insert(p);
-        ++it;
     }
     return true;
 }
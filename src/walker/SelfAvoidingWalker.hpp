@@ -3,14 +3,22 @@
 
 #include <list>
 #include <iterator>
-#include <unordered_set>
+#include <functional>
+#include <limits>
 
 #include "../Logging.hpp"
 #include "SpecWalker.hpp"
+#include "SAWTree.hpp"
+#include "../LatticeMap.hpp"
 
 /** Self-Avoiding Random Walk
  *
  * A Walk which does not self intersect.
+ * Trial moves are tested for self-intersections with a SAWTree, such
+ * that rejected moves do not need to look at the whole walk.
+ * In d=2 the tree also knows the hull of the walk, such that accepted
+ * moves only update the tree and the steps and points are fetched from
+ * it when they are needed.
  *
  * See also:
  * doi: 10.1007/978-1-4614-6025-1_9
@@ -21,13 +29,27 @@
 class SelfAvoidingWalker final : public SpecWalker<int>
 {
     public:
-        SelfAvoidingWalker(int d, int numSteps, const UniformRNG &rng, hull_algorithm_t hull_algo, bool amnesia=false);
+        SelfAvoidingWalker(int d, int numSteps, const UniformRNG &rng, hull_algorithm_t hull_algo, bool amnesia=false, bool equilibrate=true);
 
         void reconstruct() final;
         void generate_from_MCMC();
         void generate_from_dimerization();
+        /// estimate of the partition sums Z_n of PERM, the summed weights at length n per tour
+        struct PERMEstimate
+        {
+            PERMEstimate() : tours(0) {}
+            int tours;
+            std::vector<double> logSum;
+            void reset(int n);
+            void add(int n, double logW);
+            void add(const PERMEstimate &other);
+            double logZ(int n, const PERMEstimate &other) const;
+        };
+        void tourPERM(UniformRNG &rng, const std::function<void(double)> &sample, const PERMEstimate &previous);
+        const PERMEstimate& tourEstimate() const { return perm_tour; }
 
         void updateSteps() final;
+        void updateHull() final;
 
         void change(UniformRNG &rng, bool update=true) final;
         void undoChange() final;
@@ -49,9 +71,24 @@ class SelfAvoidingWalker final : public SpecWalker<int>
         void naiveChangeUndo();
 
         std::list<double> dim(int N);
-        std::unordered_set<Step<int>> overlap_test;
-        bool checkOverlapFree(const std::list<double> &l) const;
-        bool checkOverlapFree(const std::vector<Step<int>> &l) const;
+        SAWTree tree;
+        std::vector<Step<int>> tree_hull;
+        void fetchSteps() const final;
+        LatticeMap<int> overlap_test;
+        bool checkOverlapFree(const std::list<double> &l);
+
+        ///\name state of a PERM tour
+        struct PermBranch
+        {
+            int n;
+            double logW;
+        };
+        std::vector<Step<int>> perm_path;       ///< points of the growing walk
+        std::vector<Step<int>> perm_free;       ///< free neighbors of the head
+        std::vector<PermBranch> perm_stack;     ///< enriched copies still to grow
+        PERMEstimate perm_tour;                 ///< weights of the current tour
+        bool permFree(const Step<int> &p, int n) const;
+        void permSample();
 };
 
 #endif
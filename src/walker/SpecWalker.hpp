@@ -6,6 +6,7 @@
 #include <sstream>
 #include <memory>
 #include <algorithm>
+#include <array>
 
 #include "../io.hpp"
 #include "../Cmd.hpp"
@@ -40,7 +41,13 @@ class SpecWalker : public Walker
     public:
         SpecWalker(int d, int numSteps, const UniformRNG &rng, hull_algorithm_t hull_algo, bool amnesia=false)
             : Walker(d, numSteps, rng, hull_algo, amnesia),
-              m_points(numSteps+1, Step<T>(d))
+              m_points(numSteps+1, Step<T>(d)),
+              m_steps_pending(false),
+              m_offsets_pending(false),
+              m_point_block_size(0),
+              m_block_extremes_valid(false),
+              m_change_first(-1),
+              m_change_last(-1)
         {
         }
 
@@ -80,16 +87,21 @@ class SpecWalker : public Walker
         int enclosedSites() const final;
         int passage(int t1=0, int axis=0) const final;
         std::vector<double> correlation(std::vector<int> t, int axis=0) const final;
+        void observableBounds(wanted_observable_t observable, double &lower, double &upper) const final;
 
         ///\name get state
-        const std::vector<Step<T>>& steps() const { return m_steps; }
-        const std::vector<Step<T>>& points() const { return m_points; }
+        const std::vector<Step<T>>& steps() const { applyPendingSteps(); return m_steps; }
+        const std::vector<Step<T>>& points() const { applyPointOffsets(); return m_points; }
         const std::vector<Step<T>>& hullPoints() const { return m_convex_hull.hullPoints(); }
 
         ///\name update state
         virtual void updateSteps() override = 0;
         virtual void updatePoints(int start=1) override;
+        void updatePointsLazy(int start);
+        void updatePointsRange(int firstStep, int lastStep);
         virtual void updateHull() override;
+        void updateHullPartial(int firstStep, int lastStep, bool update=true);
+        void updateHullOfChange() final;
 
         ///\name visualization
         virtual void svg(const std::string filename, const bool with_hull=false) const override;
@@ -108,10 +120,43 @@ class SpecWalker : public Walker
         void goDownhill(const bool maximize, const wanted_observable_t observable, const int stagnate=1000) final;
 
     protected:
-        std::vector<Step<T>> m_steps;
-        std::vector<Step<T>> m_points;
+        mutable std::vector<Step<T>> m_steps;
+        mutable std::vector<Step<T>> m_points;
         ConvexHull<T> m_convex_hull;
-        ConvexHull<T> m_old_convex_hull;
+
+        // walkers which keep their steps elsewhere, set m_steps_pending
+        // instead of updating steps and points after a change, both are
+        // fetched by fetchSteps() as soon as they are needed
+        virtual void fetchSteps() const {}
+        void applyPendingSteps() const;
+        mutable bool m_steps_pending;
+
+        // loops over the points with the dimension known at compile time,
+        // D = 0 is the fallback for any dimension
+        template <int D> void updatePointsFixed(int start, int end) const;
+        template <int D> static void translateFixed(Step<T> *p, int count, const Step<T> &delta);
+        void translate(Step<T> *p, int count, const Step<T> &delta) const;
+
+        // pending translations of blocks of m_points, see updatePointsLazy()
+        void applyPointOffsets() const;
+        mutable std::vector<Step<T>> m_point_offsets;
+        mutable bool m_offsets_pending;
+        int m_point_block_size;
+
+        // extreme points of every block in the directions of
+        // observableBounds(), valid as long as only updatePointsLazy()
+        // changes the points
+        static T extent(int k, const Step<T> &p);
+        void updateBlockExtremes(int b) const;
+        mutable std::vector<std::array<int, 8>> m_block_extremes;
+        mutable bool m_block_extremes_valid;
+
+        // steps changed by the last change(rng, false), -1 if unknown,
+        // -2 if the walk did not change
+        int m_change_first;
+        int m_change_last;
+        void changedNothing() { m_change_first = m_change_last = -2; }
+        void forgetChange() { m_change_first = m_change_last = -1; }
 };
 
 /// Do initialization, e.g. calculate the steps and the hull.
@@ -128,7 +173,10 @@ template <class T>
 void SpecWalker<T>::reconstruct()
 {
     // write new random numers into our state
-    std::generate(random_numbers.begin(), random_numbers.end(), std::ref(rng));
+    if(on_demand)
+        random_on_demand.regenerate();
+    else
+        rng.fill(random_numbers);
     init();
 }
 
@@ -145,9 +193,64 @@ void SpecWalker<T>::generate_independent_sample()
 template <class T>
 void SpecWalker<T>::updateHull()
 {
+    applyPointOffsets();
     m_convex_hull.run(&m_points);
 }
 
+/** Update the convex hull after the steps in [firstStep, lastStep] changed.
+ *
+ * The points need to be updated already. Hull algorithms which can
+ * reuse parts of the old hull (CH_SEGMENT_TREE) will only recalculate
+ * the affected parts, all others recalculate the whole hull.
+ * If update is false, the range is only remembered for
+ * updateHullOfChange().
+ */
+template <class T>
+void SpecWalker<T>::updateHullPartial(int firstStep, int lastStep, bool update)
+{
+    if(!update)
+    {
+        m_change_first = firstStep;
+        m_change_last = lastStep;
+        return;
+    }
+    forgetChange();
+
+    // only the segment tree can work with pending translations
+    if(hull_algo != CH_SEGMENT_TREE || m_steps_pending)
+    {
+        updateHull();
+        return;
+    }
+
+    if(m_offsets_pending)
+        m_convex_hull.update(&m_points, firstStep, lastStep, &m_point_offsets, m_point_block_size);
+    else
+        m_convex_hull.update(&m_points, firstStep, lastStep);
+}
+
+/** Update the convex hull after change(rng, false).
+ *
+ * Nothing is done if the change did not change the walk, the whole
+ * hull is recalculated if the changed steps are unknown.
+ */
+template <class T>
+void SpecWalker<T>::updateHullOfChange()
+{
+    if(m_change_first == -2)
+    {
+        forgetChange();
+        return;
+    }
+    if(m_change_first < 0)
+    {
+        updateHull();
+        return;
+    }
+
+    updateHullPartial(m_change_first, m_change_last);
+}
+
 template <class T>
 const ConvexHull<T>& SpecWalker<T>::convexHull() const
 {
@@ -167,11 +270,188 @@ void SpecWalker<T>::setHullAlgo(const hull_algorithm_t a)
 template <class T>
 void SpecWalker<T>::updatePoints(const int start)
 {
-    for(int i=start; i<=numSteps; ++i)
+    applyPointOffsets();
+    m_block_extremes_valid = false;
+    switch(d)
     {
-        m_points[i].setZero();
-        m_points[i] += m_points[i-1];
-        m_points[i] += m_steps[i-1];
+        case 2:
+            updatePointsFixed<2>(start, numSteps);
+            break;
+        case 3:
+            updatePointsFixed<3>(start, numSteps);
+            break;
+        default:
+            updatePointsFixed<0>(start, numSteps);
+    }
+}
+
+/** Updates the points after the steps in [firstStep, lastStep] changed,
+ * without changing their sum, e.g., by swapping two of them.
+ *
+ * Only the points between the changed steps are recalculated, all
+ * following points stay where they are. Together with
+ * updateHullPartial(firstStep, lastStep) a change costs O(lastStep - firstStep)
+ * instead of O(numSteps).
+ */
+template <class T>
+void SpecWalker<T>::updatePointsRange(const int firstStep, const int lastStep)
+{
+    applyPointOffsets();
+    m_block_extremes_valid = false;
+    switch(d)
+    {
+        case 2:
+            updatePointsFixed<2>(firstStep+1, lastStep);
+            break;
+        case 3:
+            updatePointsFixed<3>(firstStep+1, lastStep);
+            break;
+        default:
+            updatePointsFixed<0>(firstStep+1, lastStep);
+    }
+}
+
+/** Cumulative sum of the steps, for the points start to end.
+ *
+ * For D > 0 the inner loop has a constant trip count and is unrolled
+ * by the compiler, instead of looping over the runtime dimension of
+ * every Step.
+ */
+template <class T>
+template <int D>
+void SpecWalker<T>::updatePointsFixed(const int start, const int end) const
+{
+    const int dim = D > 0 ? D : d;
+    for(int i=start; i<=end; ++i)
+        for(int k=0; k<dim; ++k)
+            m_points[i][k] = m_points[i-1][k] + m_steps[i-1][k];
+}
+
+/// Adds delta to the count points starting at p.
+template <class T>
+template <int D>
+void SpecWalker<T>::translateFixed(Step<T> *p, const int count, const Step<T> &delta)
+{
+    const int dim = D > 0 ? D : delta.d();
+    for(int i=0; i<count; ++i)
+        for(int k=0; k<dim; ++k)
+            p[i][k] += delta[k];
+}
+
+template <class T>
+void SpecWalker<T>::translate(Step<T> *p, const int count, const Step<T> &delta) const
+{
+    switch(d)
+    {
+        case 2:
+            translateFixed<2>(p, count, delta);
+            break;
+        case 3:
+            translateFixed<3>(p, count, delta);
+            break;
+        default:
+            translateFixed<0>(p, count, delta);
+    }
+}
+
+/** Updates the points of the walk after only the step start-1 changed.
+ *
+ * All following points are translated by the same vector. The points
+ * are divided into blocks of about sqrt(numSteps) points, only the
+ * block containing start is updated, all following blocks just
+ * remember the translation. It is applied, as soon as the points are
+ * needed by points(), updatePoints() or updateHull().
+ *
+ * Therefore, a change costs O(sqrt(numSteps)) instead of O(numSteps).
+ */
+template <class T>
+void SpecWalker<T>::updatePointsLazy(const int start)
+{
+    applyPendingSteps();
+    const int n = m_points.size();
+    if(start >= n)
+        return;
+
+    if(m_point_block_size * (int) m_point_offsets.size() < n)
+    {
+        applyPointOffsets();
+        m_point_block_size = 1;
+        while(m_point_block_size * m_point_block_size < n)
+            m_point_block_size *= 2;
+        int blocks = (n + m_point_block_size - 1) / m_point_block_size;
+        m_point_offsets = std::vector<Step<T>>(blocks, Step<T>(d));
+        m_block_extremes_valid = false;
+    }
+
+    const int B = m_point_block_size;
+    const int b = start / B;
+    const int end = std::min((b+1) * B, n);
+
+    // the block of start (and the point before) need to be up to date
+    Step<T> delta = m_points[start-1] + m_point_offsets[(start-1) / B];
+    delta += m_steps[start-1];
+    delta -= m_points[start] + m_point_offsets[b];
+
+    translate(m_points.data() + b*B, end - b*B, m_point_offsets[b]);
+    m_point_offsets[b].setZero();
+
+    translate(m_points.data() + start, end - start, delta);
+    for(size_t k=b+1; k<m_point_offsets.size(); ++k)
+        m_point_offsets[k] += delta;
+
+    // the extremes of all other blocks are only translated
+    if(m_block_extremes_valid)
+        updateBlockExtremes(b);
+
+    m_offsets_pending = true;
+}
+
+/// Applies all pending translations of updatePointsLazy() to the points.
+template <class T>
+void SpecWalker<T>::applyPointOffsets() const
+{
+    applyPendingSteps();
+    if(!m_offsets_pending)
+        return;
+
+    const int n = m_points.size();
+    const int B = m_point_block_size;
+    for(size_t k=0; k<m_point_offsets.size(); ++k)
+    {
+        const int end = std::min((int) (k+1) * B, n);
+        translate(m_points.data() + k*B, end - k*B, m_point_offsets[k]);
+        m_point_offsets[k].setZero();
+    }
+
+    m_offsets_pending = false;
+}
+
+/// Fetches the pending steps and recalculates all points from them.
+template <class T>
+void SpecWalker<T>::applyPendingSteps() const
+{
+    if(!m_steps_pending)
+        return;
+    m_steps_pending = false;
+
+    fetchSteps();
+
+    // the points are recalculated anyway
+    for(auto &offset : m_point_offsets)
+        offset.setZero();
+    m_offsets_pending = false;
+    m_block_extremes_valid = false;
+
+    switch(d)
+    {
+        case 2:
+            updatePointsFixed<2>(1, numSteps);
+            break;
+        case 3:
+            updatePointsFixed<3>(1, numSteps);
+            break;
+        default:
+            updatePointsFixed<0>(1, numSteps);
     }
 }
 
@@ -486,6 +766,10 @@ std::string SpecWalker<T>::print() const
 template <class T>
 double SpecWalker<T>::maxDiameter() const
 {
+    // the hull of d=2 is ordered
+    if(d == 2)
+        return rotatingCalipers(hullPoints()).diameter;
+
     double maxD = 0;
     int n_hullpoints = hullPoints().size();
     for(int i=0; i<n_hullpoints; ++i)
@@ -499,6 +783,144 @@ double SpecWalker<T>::maxDiameter() const
     return maxD;
 }
 
+/** Cheap bounds of the area and perimeter of the hull in d=2.
+ *
+ * Uses the current points, even if the hull is not updated yet. The
+ * extreme points in eight directions are found (like the Akl Toussaint
+ * heuristic), the octagon spanned by them lies inside of the hull and
+ * the bounding box contains the hull.
+ *
+ * While updatePointsLazy() has translations pending, the extremes of
+ * every block of points are cached and only the block of the last
+ * change is scanned again, such that the bounds cost O(sqrt(numSteps))
+ * and the pending translations are not applied. Otherwise all points
+ * are scanned.
+ */
+template <class T>
+void SpecWalker<T>::observableBounds(const wanted_observable_t observable, double &lower, double &upper) const
+{
+    Walker::observableBounds(observable, lower, upper);
+    if(d != 2 || (observable != WO_VOLUME && observable != WO_SURFACE_AREA))
+        return;
+
+    // the points are not worth fetching for the bounds
+    if(m_steps_pending)
+        return;
+
+    const bool blocked = m_offsets_pending;
+    const int B = m_point_block_size;
+    auto point = [&](int i) {
+        return blocked ? m_points[i] + m_point_offsets[i / B] : m_points[i];
+    };
+
+    int extreme[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    T best[8];
+    for(int k=0; k<8; ++k)
+        best[k] = extent(k, point(0));
+
+    if(blocked)
+    {
+        if(!m_block_extremes_valid)
+        {
+            m_block_extremes.resize(m_point_offsets.size());
+            for(size_t b=0; b<m_point_offsets.size(); ++b)
+                updateBlockExtremes(b);
+            m_block_extremes_valid = true;
+        }
+
+        // the blocks in order, such that ties go to the first point
+        for(size_t b=0; b<m_block_extremes.size(); ++b)
+            for(int k=0; k<8; ++k)
+            {
+                const int i = m_block_extremes[b][k];
+                const T v = extent(k, m_points[i] + m_point_offsets[b]);
+                if(v > best[k])
+                {
+                    best[k] = v;
+                    extreme[k] = i;
+                }
+            }
+    }
+    else
+    {
+        for(size_t i=1; i<m_points.size(); ++i)
+            for(int k=0; k<8; ++k)
+            {
+                const T v = extent(k, m_points[i]);
+                if(v > best[k])
+                {
+                    best[k] = v;
+                    extreme[k] = i;
+                }
+            }
+    }
+
+    Step<T> corner[8];
+    for(int k=0; k<8; ++k)
+        corner[k] = point(extreme[k]);
+
+    double a = 0, l = 0;
+    for(int k=0; k<8; ++k)
+    {
+        const Step<T> &p1 = corner[k];
+        const Step<T> &p2 = corner[(k+1) % 8];
+        a += (p1.x() - p2.x()) * (p1.y() + p2.y());
+        l += (p1 - p2).length();
+    }
+
+    const double width = corner[4].x() - corner[0].x();
+    const double height = corner[6].y() - corner[2].y();
+
+    if(observable == WO_VOLUME)
+    {
+        lower = a / 2;
+        upper = width * height;
+    }
+    else
+    {
+        lower = l;
+        upper = 2 * (width + height);
+    }
+
+    // do not be tighter than the rounding errors of the exact hull
+    lower *= 1 - 1e-9;
+    upper *= 1 + 1e-9;
+}
+
+/// Projection of p in direction k of observableBounds(), in counterclockwise order starting at minimal x.
+template <class T>
+T SpecWalker<T>::extent(const int k, const Step<T> &p)
+{
+    static const int dx[8] = {-1, -1,  0,  1, 1, 1, 0, -1};
+    static const int dy[8] = { 0, -1, -1, -1, 0, 1, 1,  1};
+    return dx[k] * p.x() + dy[k] * p.y();
+}
+
+/// Finds the first extreme point in every direction of block b, independent of its pending translation.
+template <class T>
+void SpecWalker<T>::updateBlockExtremes(const int b) const
+{
+    const int B = m_point_block_size;
+    const int begin = b * B;
+    const int end = std::min((b+1) * B, (int) m_points.size());
+
+    std::array<int, 8> &extreme = m_block_extremes[b];
+    for(int k=0; k<8; ++k)
+    {
+        extreme[k] = begin;
+        T best = extent(k, m_points[begin]);
+        for(int i=begin+1; i<end; ++i)
+        {
+            const T v = extent(k, m_points[i]);
+            if(v > best)
+            {
+                best = v;
+                extreme[k] = i;
+            }
+        }
+    }
+}
+
 /// Get the oblateness of the walk
 /// (this is not really oblateness but more the ratio of the longest and shortest diameter)
 template <class T>
@@ -510,17 +932,27 @@ double SpecWalker<T>::oblateness() const
     int n_hullpoints = hullPoints().size();
 
     // first: search the two points with largest distance
-    for(int i=0; i<n_hullpoints; ++i)
-        for(int j=0; j<i; ++j)
-        {
-            double diameter = (hullPoints()[i] - hullPoints()[j]).length();
-            if(diameter > maxLongAxis)
+    if(d == 2)
+    {
+        const Calipers c = rotatingCalipers(hullPoints());
+        maxLongAxis = c.diameter;
+        maxI = c.diameterI;
+        maxJ = c.diameterJ;
+    }
+    else
+    {
+        for(int i=0; i<n_hullpoints; ++i)
+            for(int j=0; j<i; ++j)
             {
-                maxLongAxis = diameter;
-                maxI = i;
-                maxJ = j;
+                double diameter = (hullPoints()[i] - hullPoints()[j]).length();
+                if(diameter > maxLongAxis)
+                {
+                    maxLongAxis = diameter;
+                    maxI = i;
+                    maxJ = j;
+                }
             }
-        }
+    }
 
     double maxShortAxis = 0.;
     double maxCross = 0.;
@@ -15,22 +15,26 @@ void TrueSelfAvoidingWalker::reconstruct()
     if(!amnesia)
     {
         // write new random numers into our state
-        std::generate(random_numbers.begin(), random_numbers.end(), std::ref(rng));
+        rng.fill(random_numbers);
     }
     init();
 }
 
-void TrueSelfAvoidingWalker::updateSteps()
+/// Boltzmann factor of a site with the given number of visits
+double TrueSelfAvoidingWalker::weight(int visits)
 {
-    m_steps.clear();
-    m_steps.reserve(numSteps);
+    while((int) boltzmann.size() <= visits)
+        boltzmann.push_back(std::exp(-beta*(int) boltzmann.size()));
+    return boltzmann[visits];
+}
 
-    std::unordered_map<Step<int>, int> number_of_visits;
+void TrueSelfAvoidingWalker::updateSteps()
+{
+    m_steps.resize(numSteps, Step<int>(d));
+    number_of_visits.clear();
 
     // build the whole walk here
 
-    // probabilities to step on the neighboring sites
-    std::vector<double> p(2*d);
     // current position
     Step<int> head(d);
     if(!amnesia)
@@ -38,21 +42,31 @@ void TrueSelfAvoidingWalker::updateSteps()
     else
         head.fillFromRN(rng());
 
-    m_steps.push_back(head);
-    for(int t=1; t<numSteps; ++t)
+    m_steps[0] = head;
+    walkFrom(1, head);
+}
+
+/** Grows the walk from point start at head on.
+ *
+ * The visits of all points before start need to be counted already.
+ */
+void TrueSelfAvoidingWalker::walkFrom(int start, Step<int> head)
+{
+    // probabilities to step on the neighboring sites
+    cumulative.resize(2*d);
+    Step<int> neighbor(d);
+    for(int t=start; t<numSteps; ++t)
     {
         // iterate over neighbors, to update the probabilites p
-        int ctr = 0;
         double norm = 0.;
-        std::vector<Step<int>> neighbors = head.neighbors();
         ++number_of_visits[head];
-        for(const auto &i : neighbors)
+        for(int i=0; i<2*d; ++i)
         {
-            int times_visited = number_of_visits[i];
-            double prob = std::exp(-beta*times_visited);
-            norm += prob;
-            p[ctr] = norm; // p is cumulative probability function
-            ++ctr;
+            neighbor = head;
+            neighbor[i/2] += i % 2 ? -1 : 1;
+            const int *visits = number_of_visits.find(neighbor);
+            norm += weight(visits ? *visits : 0);
+            cumulative[i] = norm; // p is cumulative probability function
         }
 
         // step on a neighbor according to p
@@ -64,15 +78,23 @@ void TrueSelfAvoidingWalker::updateSteps()
 
         int idx = 0;
         // for high dimensions a bisection would make sense, but for low not
-        while(rn > p[idx])
+        while(rn > cumulative[idx])
         {
             ++idx;
         }
-        m_steps.emplace_back(neighbors[idx] - head);
-        head = neighbors[idx];
+        m_steps[t].setZero();
+        m_steps[t][idx/2] = idx % 2 ? -1 : 1;
+        head += m_steps[t];
     }
 }
 
+/// Adds delta to the visit counts of the points from start to numSteps-1.
+void TrueSelfAvoidingWalker::visit(int start, int delta)
+{
+    for(int t=start; t<numSteps; ++t)
+        number_of_visits[m_points[t]] += delta;
+}
+
 /** Changes the walk, i.e., performs one trial move.
  *
  * \param rng Random number generator to draw the needed randomness from
@@ -80,20 +102,27 @@ void TrueSelfAvoidingWalker::updateSteps()
  */
 void TrueSelfAvoidingWalker::change(UniformRNG &rng, bool update)
 {
-    // I should do this in a far more clever way
     int idx = rng() * numSteps;
     undo_index = idx;
     undo_value = random_numbers[idx];
     random_numbers[idx] = rng();
 
-    updateSteps();
-    updatePoints();
+    // the first step does not depend on visits
+    const int start = std::max(idx, 1);
+    visit(start, -1);
+    undo_steps.assign(m_steps.begin() + idx, m_steps.end());
+    if(idx == 0)
+    {
+        Step<int> head(d);
+        head.fillFromRN(random_numbers[0]);
+        m_steps[0] = head;
+    }
+    walkFrom(start, idx == 0 ? m_steps[0] : m_points[start]);
+    updatePoints(idx+1);
 
+    m_convex_hull.beginTrial();
     if(update)
-    {
-        m_old_convex_hull = m_convex_hull;
         updateHull();
-    }
 }
 
 /// Undoes the last change.
@@ -101,9 +130,12 @@ void TrueSelfAvoidingWalker::undoChange()
 {
     random_numbers[undo_index] = undo_value;
 
-    updateSteps();
-    updatePoints();
-    m_convex_hull = m_old_convex_hull;
+    const int start = std::max(undo_index, 1);
+    visit(start, -1);
+    std::copy(undo_steps.begin(), undo_steps.end(), m_steps.begin() + undo_index);
+    updatePoints(undo_index+1);
+    visit(start, 1);
+    m_convex_hull.rollback();
 }
 
 void TrueSelfAvoidingWalker::setP1(double p1)
@@ -112,6 +144,7 @@ void TrueSelfAvoidingWalker::setP1(double p1)
     if(beta == p1)
         return;
     beta = p1;
+    boltzmann.clear();
     updateSteps();
     updatePoints();
     updateHull();
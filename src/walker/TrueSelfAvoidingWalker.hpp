@@ -3,9 +3,9 @@
 
 #include <list>
 #include <iterator>
-#include <unordered_set>
 
 #include "../Logging.hpp"
+#include "../LatticeMap.hpp"
 #include "SpecWalker.hpp"
 
 /** True Self-Avoiding Random Walk
@@ -16,6 +16,11 @@
  * See also:
  * doi: 10.1103/PhysRevB.27.1635
  *
+ * A change of random number i only affects the walk from step i on.
+ * Its visits are subtracted from the counts by walking back along the
+ * points, and only the rest of the walk is grown again. undoChange()
+ * restores the saved steps and their visits without drawing again.
+ *
  * \image html TSAW.svg "example of a true self-avoiding walk, \f$\beta = 1\f$"
  */
 class TrueSelfAvoidingWalker final : public SpecWalker<int>
@@ -32,6 +37,16 @@ class TrueSelfAvoidingWalker final : public SpecWalker<int>
 
         double beta;
         void setP1(double beta) final;
+
+    protected:
+        LatticeMap<int> number_of_visits;
+        std::vector<double> boltzmann;      ///< \f$\exp(-\beta n)\f$ for n visits
+        std::vector<double> cumulative;     ///< cumulative probabilities of the neighbors
+        std::vector<Step<int>> undo_steps;
+
+        double weight(int visits);
+        void walkFrom(int start, Step<int> head);
+        void visit(int start, int delta);
 };
 
 #endif
@@ -5,14 +5,28 @@ Walker::Walker(int d, int numSteps, const UniformRNG &rng, hull_algorithm_t hull
       d(d),
       rng(rng),
       hull_algo(hull_algo),
-      amnesia(amnesia)
+      amnesia(amnesia),
+      on_demand(false)
 {
 }
 
+/** Cheap bounds of an observable, without calculating the hull.
+ *
+ * Walkers, which do not know anything cheaper than the hull itself,
+ * return infinite bounds.
+ */
+void Walker::observableBounds(const wanted_observable_t /*observable*/, double &lower, double &upper) const
+{
+    lower = -std::numeric_limits<double>::infinity();
+    upper = std::numeric_limits<double>::infinity();
+}
+
 /** Get the number of random numbers used.
  */
 int Walker::nRN() const
 {
+    if(on_demand)
+        return random_on_demand.size() * random_on_demand.width();
     return random_numbers.size();
 }
 
@@ -45,9 +59,20 @@ std::string Walker::serialize()
     //~ std::string rng_state(rng.serialize_rng());
     //~ binary_write(ss, rng_state.size());
     //~ binary_write_string(ss, rng_state);
-    binary_write(ss, random_numbers.size());
-    for(const double i : random_numbers)
-        binary_write(ss, i);
+    if(on_demand)
+    {
+        // same format as stored random numbers
+        binary_write(ss, (size_t) random_on_demand.size() * random_on_demand.width());
+        for(int i=0; i<random_on_demand.size(); ++i)
+            for(int k=0; k<random_on_demand.width(); ++k)
+                binary_write(ss, random_on_demand(i, k));
+    }
+    else
+    {
+        binary_write(ss, random_numbers.size());
+        for(const double i : random_numbers)
+            binary_write(ss, i);
+    }
 
     return ss.str();
 }
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream>
 #include <memory>
+#include <limits>
 
 #include "../io.hpp"
 #include "../Cmd.hpp"
@@ -16,7 +17,8 @@
  * visualize and get observables the Walker and its hull.
  *
  * Saves a vector of random numbers [0,1] and generates a random walk
- * on demand.
+ * on demand. Some walkers can calculate the random numbers on demand,
+ * too, see setOnDemandRN().
  *
  * Also exhibits functions to change random numbers in that
  * vector and convinience functions to calculate the convex hull
@@ -40,6 +42,7 @@ class Walker
         virtual void setP1(double /*p1*/) { LOG(LOG_WARNING) << "P1 not used for this type of random walk"; }
         virtual void setP2(double /*p2*/) { LOG(LOG_WARNING) << "P2 not used for this type of random walk"; }
         virtual void setP3(double /*p3*/) { LOG(LOG_WARNING) << "P3 not used for this type of random walk"; }
+        virtual void setOnDemandRN() { LOG(LOG_WARNING) << "random numbers on demand not supported for this type of random walk"; }
 
         // convenience functions
         virtual double A() const = 0;   ///< Returns the Volume of the convex hull
@@ -64,6 +67,7 @@ class Walker
         virtual int enclosedSites() const = 0;          ///< number of sites enclosed in the walk
         virtual int passage(int t1=0, int axis=0) const = 0; ///< first passage of x=0 after t1
         virtual std::vector<double> correlation(std::vector<int> t, int axis=0) const = 0; ///< output a vector of points to calculate a correlation later
+        virtual void observableBounds(wanted_observable_t observable, double &lower, double &upper) const;
 
         /** Change the Walker by a small amount, appropiate for the type.
          *
@@ -78,6 +82,9 @@ class Walker
         virtual void updateSteps() = 0;
         virtual void updatePoints(int start=1) = 0;
         virtual void updateHull() = 0;
+        /// Updates the hull after change(rng, false), only the changed
+        /// part, if the walker knows it.
+        virtual void updateHullOfChange() { updateHull(); }
 
         virtual void degenerateMaxVolume() = 0;
         virtual void degenerateMaxSurface() = 0;
@@ -105,6 +112,8 @@ class Walker
         mutable std::vector<double> random_numbers;
         hull_algorithm_t hull_algo;
         bool amnesia; ///< if true, will not remember used random numbers, useful for non memory intensive simple sampling
+        bool on_demand; ///< if true, random_on_demand replaces random_numbers
+        OnDemandRN random_on_demand;
 
         int undo_index;
         double undo_value;